@@ -0,0 +1,108 @@
+/*
+ * Auction.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Bertsekas' auction algorithm with epsilon-scaling for the linear
+ * assignment problem. Unassigned rows bid for their best column, raising its price by
+ * the gap to their second best plus epsilon. Each scaling phase keeps the prices of
+ * the last one and shrinks epsilon until the result is within n*epsilon of optimal.
+ * With one thread rows bid one at a time (Gauss-Seidel). With more, every unassigned
+ * row bids in parallel and each column goes to its highest bidder (Jacobi).
+ * Rectangular matrices are padded to square with zero-cost entries, costs >= INF are
+ * only used when nothing else is possible.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "defines.h"
+
+#define DEBUG_AUCTION	DEBUG || 0
+// Epsilon shrinks by this factor between scaling phases
+#define AUCTION_EPS_FACTOR	5.0
+// Final epsilon, relative to the range of the costs (before dividing by n)
+#define AUCTION_EPS_FINAL	1e-9
+
+class Auction {
+public:
+	Auction();
+	~Auction();
+
+	// Sets the number of bidding threads: 1 bids Gauss-Seidel, more bid Jacobi in parallel
+	void SetThreads(int nThreads);
+
+	/*
+	 * Minimizes the cost of assigning each row of DistMatrix to a unique column.
+	 * Assignment[row] is set to the assigned column, or -1 if the row could not be
+	 * assigned (more rows than columns). Returns the cost of the assignment.
+	 */
+	double Solve(std::vector<std::vector<double>>& DistMatrix, std::vector<int>& Assignment);
+	// Same as above for an nRows x nCols row-major matrix
+	double Solve(const double* CostMatrix, int nRows, int nCols, std::vector<int>& Assignment);
+
+	// Bidding rounds in the last Solve() (single bids when bidding Gauss-Seidel)
+	long int GetIterations() {return m_nIterations;}
+	// Epsilon of the last scaling phase in the last Solve()
+	double GetEpsilon() {return m_fEpsilon;}
+	// Duality gap of the last Solve(), bounds how far its cost is from optimal
+	double GetGap() {return m_fGap;}
+
+private:
+	// Runs the auction on the n x n row-major matrix in m_vBenefit, fills m_vRowSol
+	void solveSquare(int n);
+	// One scaling phase, bidding one row at a time
+	void gaussSeidelPhase(int n, double eps);
+	// One scaling phase, all unassigned rows bid in parallel
+	void jacobiPhase(int n, double eps);
+	// Finds row i's best column and its bid, returns the column
+	int bid(int n, int i, double eps, double* bidPrice);
+	// Computes bids for m_vUnassigned[first..last)
+	void bidRange(int n, double eps, int first, int last);
+	// Dual bound minus primal benefit of the current assignment
+	double dualityGap(int n);
+
+	// Thread pool for Jacobi bidding, workers run bidRange() on their share of a round
+	void startPool();
+	void stopPool();
+	void workerLoop(int t);
+	void runRound(int n, double eps);
+
+	int m_nThreads;
+	long int m_nIterations;
+	double m_fEpsilon;
+	double m_fGap;
+
+	// Benefit (negated cost) of each row/column pair, row-major n x n
+	std::vector<double> m_vBenefit;
+	std::vector<double> m_vPrice;
+	// Column of each row and row of each column, -1 if free
+	std::vector<int> m_vRowSol;
+	std::vector<int> m_vColSol;
+	// Jacobi workspace: the unassigned rows, their bids and the best bid on each column this round
+	std::vector<int> m_vUnassigned;
+	std::vector<int> m_vBidColumn;
+	std::vector<double> m_vBidPrice;
+	std::vector<int> m_vWinner;
+	std::vector<long int> m_vRoundSeen;
+
+	// Pool state
+	std::vector<std::thread> m_vWorkers;
+	std::mutex m_mutex;
+	std::condition_variable m_cvStart;
+	std::condition_variable m_cvDone;
+	long int m_nGeneration;
+	int m_nPending;
+	bool m_bQuit;
+	int m_nRoundN;
+	double m_fRoundEps;
+	int m_nRoundSize;
+};
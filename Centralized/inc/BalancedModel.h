@@ -0,0 +1,74 @@
+/*
+ * BalancedModel.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Slot tables for the matching formulations of MASP. The matching solvers
+ * expand each task j into d_j required slots (1.1 1.2 2.1 ..) and then either give every
+ * task a_f floating slots of its own (balanced matching, np = a_r + M*a_f slots) or put
+ * N - a_r floating slots after all of the tasks (N x N matching). The tables are built
+ * once per solve so that mapping a slot back to its task is a lookup instead of a walk
+ * over the tasks.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+#include "defines.h"
+#include "MASPInput.h"
+
+#define DEBUG_BALMODEL	DEBUG || 0
+
+enum {
+	e_Layout_Balanced=0,	// d_j required then a_f floating slots per task
+	e_Layout_Square=1,		// d_j required slots per task, then N - a_r floating slots
+};
+
+class BalancedModel {
+public:
+	BalancedModel();
+	~BalancedModel();
+
+	// Builds the slot tables for input in the given layout
+	void Build(MASPInput* input, int layout);
+
+	// Task that slot belongs to, -1 for a floating slot in the square layout
+	int Task(int slot) const {
+		checkSlot(slot);
+		return m_vSlotTask[slot];
+	}
+	// Is slot a floating slot?
+	bool Floating(int slot) const {
+		checkSlot(slot);
+		return m_vSlotFloating[slot];
+	}
+	// Agent behind row i of the matching, -1 for a phantom agent
+	int Agent(int i) const {return (i < m_nN) ? i : -1;}
+
+	// Number of slots (columns of the matching)
+	int Size() const {return m_vSlotTask.size();}
+	// Number of required agents, sum of d_j
+	int RequiredAgents() const {return m_nRequired;}
+	// Number of floating agents, N - a_r
+	int FloatingAgents() const {return m_nFloating;}
+
+private:
+	void checkSlot(int slot) const {
+		if(slot < 0 || slot >= (int)m_vSlotTask.size()) {
+			// Something went wrong -> hard fail!
+			fprintf(stderr, "[BalancedModel::checkSlot] : Bad slot = %d, %d slots\n", slot, (int)m_vSlotTask.size());
+			exit(1);
+		}
+	}
+
+	int m_nN;
+	int m_nRequired;
+	int m_nFloating;
+	std::vector<int> m_vSlotTask;
+	std::vector<bool> m_vSlotFloating;
+};
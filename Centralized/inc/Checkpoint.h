@@ -0,0 +1,88 @@
+/*
+ * Checkpoint.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Binary snapshot of a depth-first exact search, so a long run can be
+ * stopped and picked up later. It holds where the search is (the task taken at each
+ * depth of the current path and the next child each node on it tries, see
+ * SearchEngine::Save()), the incumbent, the counters so far and enough about the input
+ * and options to refuse a checkpoint of a different search. Every field is written as
+ * fixed-size values (32-bit ints, 64-bit counters) in native byte order, in the order of
+ * the members below, behind a magic number and a format version. A FNV-1a checksum of
+ * everything before it ends the file, so a partly written or damaged file is refused.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+#include "MASPInput.h"
+#include "SolverStats.h"
+
+#define DEBUG_CHECKPOINT	DEBUG || 0
+// First bytes of every checkpoint file and the format version
+#define CHECKPOINT_MAGIC	"MASPCKPT"
+#define CHECKPOINT_VERSION	4
+// Largest N or M a checkpoint may hold and longest options vector, bounds what Read() allocates
+#define CHECKPOINT_MAX_DIM	(1 << 20)
+#define CHECKPOINT_MAX_OPTIONS	64
+// Starting value of the FNV-1a hashes
+#define CHECKPOINT_FNV_BASIS	14695981039346656037ULL
+
+class Checkpoint {
+public:
+	Checkpoint();
+	~Checkpoint();
+
+	/*
+	 * Writes the checkpoint to a temporary file next to path and renames it over path, so
+	 * the last good checkpoint survives a crash mid-write. Returns false on I/O errors.
+	 */
+	bool Write(const std::string& path);
+	/*
+	 * Reads path into this object, returns false if it can't be read, isn't a checkpoint of
+	 * this version, fails its checksum or has vectors that don't fit its N
+	 */
+	bool Read(const std::string& path);
+	// Hash of everything in input the search depends on (N, M, d_j, p_ij and who can do what)
+	static uint64_t InputHash(MASPInput* input);
+
+	// Input the search ran on
+	uint64_t nInputHash;
+	int nN;
+	int nM;
+	// Search options that shape the tree (solver-defined) and the agent order
+	std::vector<int> vOptions;
+	std::vector<int> vOrder;
+	// Did the search finish? (no path to resume then)
+	bool bDone;
+	// Incumbent Z and the task of each agent in it (-1 if none)
+	double fIncumbent;
+	std::vector<int> vIncumbent;
+	// Counters of the search so far
+	SolverStats stats;
+	// Where the search is (see SearchEngine::Save())
+	std::vector<int> vPath;
+	std::vector<int> vNext;
+
+private:
+	// Raw writes and reads of one value or a length-prefixed vector, false on I/O errors. Both add the bytes to m_nChecksum
+	bool put(FILE* file, const void* data, size_t bytes);
+	bool get(FILE* file, void* data, size_t bytes);
+	bool putVector(FILE* file, const std::vector<int>& v);
+	// Also false if v would be longer than maxSize
+	bool getVector(FILE* file, std::vector<int>& v, int maxSize);
+	// Adds bytes to the FNV-1a hash
+	static void mix(uint64_t* hash, const void* data, size_t bytes);
+
+	// FNV-1a hash of the bytes written or read so far
+	uint64_t m_nChecksum;
+};
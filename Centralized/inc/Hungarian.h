@@ -17,9 +17,46 @@
 
 #include <iostream>
 #include <vector>
+#include <cstddef>
+
+#include "LAPJV.h"
+#include "Auction.h"
+#include "SparseLAP.h"
 
 using namespace std;
 
+// Algorithms that HungarianAlgorithm::Solve() can run
+enum {
+	e_Assign_Munkres = 0,
+	e_Assign_LAPJV = 1,
+	e_Assign_Auction = 2,
+	e_Assign_Sparse = 3
+};
+
+
+// Buffers for HungarianAlgorithm, owned by the caller and reused across calls
+class HungarianWorkspace
+{
+public:
+	HungarianWorkspace();
+	~HungarianWorkspace();
+	HungarianWorkspace(const HungarianWorkspace&) = delete;
+	HungarianWorkspace& operator=(const HungarianWorkspace&) = delete;
+
+	// Grows the buffers to fit an nOfRows x nOfColumns problem (never shrinks)
+	void Reserve(int nOfRows, int nOfColumns);
+
+	double *distMatrix;
+	int *assignment;
+	bool *coveredColumns, *coveredRows, *starMatrix, *newStarMatrix, *primeMatrix;
+	LAPJV lapjv;
+	Auction auction;
+	SparseLAP sparse;
+
+private:
+	size_t nElementCap, nRowCap, nColumnCap;
+};
+
 
 class HungarianAlgorithm
 {
@@ -27,11 +64,24 @@ public:
 	HungarianAlgorithm();
 	~HungarianAlgorithm();
 	double Solve(vector <vector<double> >& DistMatrix, vector<int>& Assignment);
+	// Solves the nRows x nCols row-major CostMatrix using the buffers in Workspace, makes no allocations once the buffers are big enough
+	double Solve(const double* CostMatrix, int nRows, int nCols, vector<int>& Assignment, HungarianWorkspace& Workspace);
+	// Selects the algorithm used by Solve() (e_Assign_*)
+	void SetMethod(int method) {m_nMethod = method;}
+	int GetMethod() {return m_nMethod;}
+	// Auction solver behind the first Solve() (e_Assign_Auction), its rounds, epsilon and gap describe the last call
+	Auction& GetAuction() {return m_workspace.auction;}
+	// Number of threads for methods that can use more than one (e_Assign_Auction)
+	void SetThreads(int threads) {m_nThreads = threads;}
 
 private:
-	void assignmentoptimal(int *assignment, double *cost, double *distMatrix, int nOfRows, int nOfColumns);
+	int m_nMethod;
+	int m_nThreads;
+	HungarianWorkspace m_workspace;
+
+	void assignmentoptimal(int *assignment, double *cost, const double *distMatrix, int nOfRows, int nOfColumns, HungarianWorkspace& workspace);
 	void buildassignmentvector(int *assignment, bool *starMatrix, int nOfRows, int nOfColumns);
-	void computeassignmentcost(int *assignment, double *cost, double *distMatrix, int nOfRows);
+	void computeassignmentcost(int *assignment, double *cost, const double *distMatrix, int nOfRows);
 	void step2a(int *assignment, double *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
 	void step2b(int *assignment, double *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
 	void step3(int *assignment, double *distMatrix, bool *starMatrix, bool *newStarMatrix, bool *primeMatrix, bool *coveredColumns, bool *coveredRows, int nOfRows, int nOfColumns, int minDim);
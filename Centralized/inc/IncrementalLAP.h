@@ -0,0 +1,72 @@
+/*
+ * IncrementalLAP.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Square linear assignment solver that keeps its matching and dual
+ * potentials between calls. Solve() runs n shortest augmenting paths (O(n^3)). After
+ * that, changing one row or column, adding a row/column pair or removing one only
+ * breaks the matching for a single row, so the solution is repaired with one shortest
+ * augmenting path (O(n^2)) over the reduced costs instead of solving from scratch.
+ * Rectangular problems should be padded to square by the caller (see LAPJV).
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+#include "defines.h"
+
+#define DEBUG_INCLAP	DEBUG || 0
+
+class IncrementalLAP {
+public:
+	IncrementalLAP();
+	~IncrementalLAP();
+
+	// Solves the n x n problem CostMatrix from scratch and keeps it for the updates below. Returns the cost
+	double Solve(const std::vector<std::vector<double>>& CostMatrix);
+	// Replaces the costs of row i, returns the new optimal cost
+	double UpdateRow(int i, const std::vector<double>& row);
+	// Replaces the costs of column j, returns the new optimal cost
+	double UpdateColumn(int j, const std::vector<double>& col);
+	/*
+	 * Adds a row and a column, n -> n+1. row holds the n+1 costs of the new row (new column
+	 * last), col holds the costs of the n existing rows in the new column. Returns the new
+	 * optimal cost.
+	 */
+	double Add(const std::vector<double>& row, const std::vector<double>& col);
+	// Removes row i and column j, n -> n-1. Later rows/columns shift down by one. Returns the new optimal cost
+	double RemoveRowColumn(int i, int j);
+
+	// Column assigned to row i
+	int Assignment(int i) {return m_vRowSol.at(i);}
+	// Number of rows (and columns)
+	int Size() {return m_vvCost.size();}
+	// Cost of the current assignment
+	double Cost();
+
+private:
+	// Matches free row i0 along a shortest augmenting path, updating the duals. O(n^2)
+	void augment(int i0);
+	// Hard fails if i is not a valid row/column index
+	void checkIndex(int i, const char* func);
+
+	// Cost of each row/column pair
+	std::vector<std::vector<double>> m_vvCost;
+	// Row and column duals, c_ij - u_i - v_j >= 0 with equality on matched pairs
+	std::vector<double> m_vU;
+	std::vector<double> m_vV;
+	// Matching, -1 if free
+	std::vector<int> m_vRowSol;
+	std::vector<int> m_vColSol;
+	// augment() workspace
+	std::vector<double> m_vMinV;
+	std::vector<int> m_vWay;
+	std::vector<bool> m_vUsed;
+};
@@ -0,0 +1,53 @@
+/*
+ * LAPJV.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Jonker-Volgenant shortest augmenting path solver for the linear
+ * assignment problem ("A shortest augmenting path algorithm for dense and sparse
+ * linear assignment problems", Computing 38, 1987). Runs column reduction, reduction
+ * transfer and two rounds of augmenting row reduction before a Dijkstra-like
+ * augmentation for each row left free. O(n^3) worst case, much faster than Munkres
+ * in practice. Rectangular matrices are padded to square with zero-cost entries.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+#include <limits>
+
+#include "defines.h"
+
+#define DEBUG_LAPJV	DEBUG || 0
+
+class LAPJV {
+public:
+	LAPJV();
+	~LAPJV();
+
+	/*
+	 * Minimizes the cost of assigning each row of DistMatrix to a unique column.
+	 * Assignment[row] is set to the assigned column, or -1 if the row could not be
+	 * assigned (more rows than columns). Returns the cost of the assignment.
+	 */
+	double Solve(std::vector<std::vector<double>>& DistMatrix, std::vector<int>& Assignment);
+	// Same as above for an nRows x nCols row-major matrix, square matrices are solved in place
+	double Solve(const double* CostMatrix, int nRows, int nCols, std::vector<int>& Assignment);
+
+private:
+	// Runs the solver on the n x n row-major matrix cost, fills m_vRowSol/m_vColSol
+	void solveSquare(const double* cost, int n);
+
+	// Workspace, kept between calls to avoid re-allocating
+	std::vector<double> m_vCost;
+	std::vector<int> m_vRowSol;
+	std::vector<int> m_vColSol;
+	std::vector<double> m_vV;
+	std::vector<double> m_vD;
+	std::vector<int> m_vFree;
+	std::vector<int> m_vColList;
+	std::vector<int> m_vMatches;
+	std::vector<int> m_vPred;
+};
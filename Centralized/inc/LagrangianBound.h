@@ -0,0 +1,87 @@
+/*
+ * LagrangianBound.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Upper bound on Z for the exact solvers from a Lagrangian relaxation of the
+ * one-task-per-agent constraint. In log space Z = sum_j log P_j(S_j) where S_j are the
+ * agents on task j. Dropping the constraint that agent i is in at most one S_j and adding
+ * lambda_i*(1 - #tasks i is on) for lambda_i >= 0 gives, for any lambda,
+ *
+ *   log Z <= sum_i lambda_i + sum_j max_S [log P_j(S) - sum_{i in S} lambda_i]
+ *
+ * The inner max is bounded in polynomial time by looking at each subset size k: the best
+ * P_j over k agents is reached by the k most likely agents and the smallest penalty is the
+ * sum of the k smallest multipliers. With lambda = 0 this is the optimistic bound (every
+ * agent on every task it can do). The multipliers are set once at the root by subgradient
+ * descent and reused unchanged down the tree, where agents that are already assigned only
+ * count towards their own task.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <algorithm>
+
+#include "defines.h"
+#include "MASPInput.h"
+#include "PoissonBinomial.h"
+#include "SearchEngine.h"
+
+#define DEBUG_LAGRANGE	DEBUG || 0
+// Subgradient iterations at the root, and how many without improvement before the step is halved
+#define LAGRANGE_ITERATIONS	200
+#define LAGRANGE_PATIENCE	5
+
+// Bound used to prune in branch-and-match (SolverOptions::nBound)
+enum {
+	e_Bound_Optimistic = 0,
+	e_Bound_Lagrangian = 1,
+};
+
+class LagrangianBound {
+public:
+	LagrangianBound();
+	~LagrangianBound();
+
+	/*
+	 * Sets the multipliers for input by subgradient descent on the root bound, using
+	 * poissonB to evaluate tails. incumbent is the best known Z (0 if none), it sets the
+	 * step size and stops the descent once the root bound falls below it.
+	 */
+	void Init(MASPInput* input, PoissonBinomial* poissonB, double incumbent);
+	// Bound of the current state of engine: assigned agents stay on their task, the rest are free
+	double Bound(SearchEngine& engine);
+	// Bound at the root with the final multipliers
+	double Root() {return m_fRoot;}
+	// Multiplier of agent i
+	double Lambda(int i) {return m_vLambda[i];}
+
+private:
+	/*
+	 * Log of the bound with the current multipliers when agent i is on task[i] (-1 if free).
+	 * With record set, m_vCount[i] is the number of tasks whose maximizing subset charged
+	 * agent i (the subgradient is 1 - m_vCount[i] for free agents).
+	 */
+	double logBound(const std::vector<int>& task, bool record);
+	// Sorts the agents of each task by increasing multiplier
+	void sortByLambda();
+
+	MASPInput* m_pInput;
+	PoissonBinomial* m_pPoissonB;
+	double m_fRoot;
+	// Multiplier of each agent
+	std::vector<double> m_vLambda;
+	// Per task: agents that can do it by decreasing p_ij, and by increasing multiplier
+	std::vector<std::vector<int>> m_vvByP;
+	std::vector<std::vector<int>> m_vvByLambda;
+	// Subgradient counts (see logBound()) and PMF workspace
+	std::vector<int> m_vCount;
+	std::vector<double> m_vPMF;
+	// Task of each agent, filled from the engine in Bound()
+	std::vector<int> m_vTask;
+};
@@ -63,6 +63,12 @@ public:
 	bool iCanDoj(int i, int j);
 	// Determines a theoretical upper bound on a possible solution
 	double UpperBound();
+	/*
+	 * Groups agents with the same capabilities and p_ij values within tolerance of each
+	 * other into classes. Each agent joins the class of the first agent it matches.
+	 * agentClass[i] is set to the class of agent i. Returns the number of classes.
+	 */
+	int AgentClasses(double tolerance, std::vector<int>& agentClass);
 	std::string input_fileName;
 
 
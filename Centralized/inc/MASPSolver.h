@@ -15,6 +15,11 @@
 
 #include "Solver.h"
 #include "Hungarian.h"
+#include "MinCostFlow.h"
+#include "BalancedModel.h"
+#include "MoveGainTable.h"
+#include "SearchEngine.h"
+#include "TranspositionTable.h"
 
 #define DEBUG_MASPSOLV	DEBUG || 0
 
@@ -24,12 +29,55 @@ public:
 	MASPSolver();
 	virtual ~MASPSolver();
 
+	// Also selects the assignment algorithm of mHungAlgo and its threads
+	void SetOptions(const SolverOptions& options) override;
+
 protected:
+	/*
+	 * Best-improvement local search over single-agent moves. Repeatedly applies the move
+	 * with the largest gain in log(Z) until no move improves the solution in x_ij. Moves
+	 * that would drop a task below d_j zero out Z and are never taken from a valid start.
+	 * Returns the number of moves made.
+	 */
+	int BestImprovementSearch(MASPInput* input, bool** x_ij);
+	/*
+	 * Runs mHungAlgo on costMatrix, recording the call and the time it took in m_stats.
+	 * Returns the cost of the assignment.
+	 */
+	double solveAssignment(std::vector<std::vector<double>>& costMatrix, std::vector<int>& assignment);
+	// Same as above for an nRows x nCols row-major costMatrix, reusing the buffers in workspace
+	double solveAssignment(const double* costMatrix, int nRows, int nCols, std::vector<int>& assignment, HungarianWorkspace& workspace);
+	/*
+	 * Solves the assignment of nRows rows to nCols columns using only the given edges,
+	 * recording the call in m_stats. Returns false if some row cannot be assigned.
+	 */
+	bool solveSparseAssignment(int nRows, int nCols, const std::vector<SparseEdge_t>& edges, std::vector<int>& assignment);
+
+	/*
+	 * Solves the balanced matching as a transportation problem: each agent goes to one
+	 * task and task j gets between d_j and d_j + a_f agents. cost is row-major N x M with
+	 * INF marking pairs that cannot be matched. Fills agentTask with each agent's task.
+	 * Returns false if no such assignment exists.
+	 */
+	bool solveTransportation(MASPInput* input, const std::vector<double>& cost, std::vector<int>& agentTask);
+	// Sets the agent/task orders and, with the symmetry option, the classes of interchangeable agents of engine (after SearchEngine::Init())
+	void configureSearch(MASPInput* input, SearchEngine& engine);
+	// Sets up table for dominance pruning if the options ask for it (it needs pruning on and symmetry off), returns whether it is on
+	bool configureDominance(MASPInput* input, TranspositionTable& table);
+
 	// Hungarian Algorithm solver
 	HungarianAlgorithm mHungAlgo;
+	// Min-cost flow solver behind solveTransportation()
+	MinCostFlow m_flow;
+	// Sparse assignment solver behind solveSparseAssignment()
+	SparseLAP m_sparseLAP;
 
 private:
 
 	// Sets a = min(a, b), returns true if b < a
 	bool ckmin(double* a, double b);
+	// Adds the rounds, final epsilon and duality gap of auction's last solve to m_stats
+	void recordAuction(Auction& auction);
+	// Body of solveTransportation(), which times it
+	bool transport(MASPInput* input, const std::vector<double>& cost, std::vector<int>& agentTask);
 };
@@ -38,12 +38,4 @@ private:
 	// Number of participants for SMP
 	int np;
 
-	// Takes balanced matching index and converts it into the corresponding task's index
-	int get_task(int j, MASPInput* input);
-	// Takes balanced matching index and converts it into the corresponding agent's index.
-	// Returns -1 if this is a phantom
-	int get_agent(int i, MASPInput* input);
-	// Determines if this is a floating task
-	bool floating_task(int j, MASPInput* input);
-	int resolve_task(int jj, MASPInput* input);
 };
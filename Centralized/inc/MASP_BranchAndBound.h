@@ -17,6 +17,7 @@
 #include "Utilities.h"
 #include "MASPSolver.h"
 #include "MASP_MatchGS.h"
+#include "SearchEngine.h"
 
 #define DEBUG_MASP_BNB	DEBUG || 0
 
@@ -52,34 +53,29 @@ struct BnBAgent_t {
 
 
 
-class MASP_BranchAndBound : public MASPSolver {
+class MASP_BranchAndBound : public MASPSolver, public SearchHooks {
 public:
 	MASP_BranchAndBound();
 
 	void Solve(MASPInput* input, I_solution* I_final);
+	// Symmetry within a tolerance only gives an optimum up to it
+	bool IsExact() override {return !(m_options.bSymmetry && m_options.fSymmetryTol > 0);}
 
 protected:
 private:
-	void assign_next(MASPInput* input, int i, bool** x_ij, I_solution* I_crnt, std::vector<BnBAgent_t>& agentMap);
-	// Determine if this is a valid solution
-	bool valid_solution(MASPInput* input, bool** x_ij);
+	// Search hooks: count the node and check the clock, prune children, score complete assignments
+	bool OnNode(SearchEngine& engine) override;
+	bool OnAssign(SearchEngine& engine, int i, int j) override;
+	void OnLeaf(SearchEngine& engine) override;
 	// Counts the number of recursive states required to iterate through (just FYI)
 	long int countRecursiveStates(std::vector<BnBAgent_t>& agents);
-	// Takes balanced matching index and converts it into the corresponding agent's index.
-	// Returns -1 if this is a phantom
-	int get_agent(int i, int N);
-	// Takes balanced matching index and converts it into the corresponding task's index
-	int get_task(int bal_j, int M, int a_f, std::vector<int>& d_j);
-	// Determines if this is a floating task
-	bool floating_task(int bal_j, int M, int a_f, std::vector<int>& d_j);
 
 	// Best found solution
 	double fGlobalProbSuccess;
 	bool** bGlobalX_ij;
-	// Performance statistics
-	long int nInvalidCount;
-	long int nPruningCount;
 
 	// Poisson Binomial helper
 	PoissonBinomial m_PoissonB;
+	// Walks the agents in sorted order
+	SearchEngine m_engine;
 };
@@ -15,19 +15,27 @@
 #include <cmath>
 #include <algorithm>
 #include <vector>
+#include <atomic>
+#include <mutex>
+#include <queue>
+#include <chrono>
 
 #include "Utilities.h"
 #include "MASPSolver.h"
 #include "MASP_MatchGS.h"
+#include "WorkStealingPool.h"
+#include "SearchEngine.h"
+#include "LagrangianBound.h"
+#include "Checkpoint.h"
 
 #define DEBUG_MASP_BNM	DEBUG || 0
-
-// Sort agents by branching factor
-//#define SORT_AGENTS		1
-// Allow the algorithm to prune branches
-//#define PRUNING			1
-// Give the algorithm a heuristic start
-//#define HEURISTIC_START	1
+// With more than one thread, every node above the split depth is its own task and the split
+// depth is the first depth with at least this many nodes per thread
+#define BNM_TASKS_PER_THREAD	8
+// How far below the split depth a thread hands out children while other threads are idle
+#define BNM_SPLIT_EXTRA		4
+// With checkpointing on, the clock is read every this many nodes (minus one, a mask) to see if a checkpoint is due
+#define BNM_CHECKPOINT_MASK	4095
 
 struct BnMAgent_t {
 	int branchFactor;
@@ -58,36 +66,126 @@ struct BnMAgent_t {
 	}
 };
 
+// Open node of the best-first search: the tasks taken down to it and its bound
+struct BnMOpen_t {
+	double bound;
+	std::vector<int> path;
+
+	// Highest bound first, deeper first on ties
+	bool operator<(const BnMOpen_t& other) const {
+		if(bound != other.bound) {
+			return bound < other.bound;
+		}
+		return path.size() < other.path.size();
+	}
+	// Memory held by this node
+	size_t Bytes() const {return sizeof(BnMOpen_t) + path.capacity()*sizeof(int);}
+};
+
+class MASP_BranchAndMatch;
+
+// Search state of one thread: its search engine, evaluation helper, bound, matching workspace and counters
+struct BnMContext_t : public SearchHooks {
+	int nThread;
+	MASP_BranchAndMatch* pSolver;
+	SearchEngine engine;
+	PoissonBinomial poissonB;
+	LagrangianBound lagrangian;
+	SolverStats stats;
+
+	// Per depth i: task matched to each unassigned agent before depth i is assigned, or -1
+	std::vector<std::vector<int>> vvMatching;
+	// Per depth i: remaining demand of each task before i is assigned
+	std::vector<std::vector<int>> vvDemand;
+	// Hopcroft-Karp workspace: unassigned agents, agents on each task, load on each task, BFS layers and queue
+	std::vector<int> vFree;
+	std::vector<std::vector<int>> vvTaskAgents;
+	std::vector<int> vLoad;
+	std::vector<int> vLayer;
+	std::vector<int> vQueue;
 
+	BnMContext_t(int thread, MASPInput* input, MASP_BranchAndMatch* solver);
+	~BnMContext_t();
+	BnMContext_t(const BnMContext_t&) = delete;
+	BnMContext_t& operator=(const BnMContext_t&) = delete;
+
+	// Search hooks, passed on to the solver
+	bool OnNode(SearchEngine& engine) override;
+	bool OnAssign(SearchEngine& engine, int i, int j) override;
+	void OnLeaf(SearchEngine& engine) override;
+	void OnReplay(SearchEngine& engine, int i, int j) override;
+};
 
 class MASP_BranchAndMatch : public MASPSolver {
 public:
 	MASP_BranchAndMatch();
 
 	void Solve(MASPInput* input, I_solution* I_final);
+	// Symmetry within a tolerance only gives an optimum up to it
+	bool IsExact() override {return !(m_options.bSymmetry && m_options.fSymmetryTol > 0);}
 
 protected:
 private:
-	void assign_next(MASPInput* input, int i, bool** x_ij, I_solution* I_crnt, std::vector<BnMAgent_t>& agentMap);
-	// Determine if this is a valid solution
-	bool valid_solution(MASPInput* input, bool** x_ij);
+	friend struct BnMContext_t;
+
+	// Search hooks of a context: count the node and check the clock, prune children, score complete assignments
+	bool on_node(BnMContext_t& ctx);
+	bool on_assign(BnMContext_t& ctx, int i, int j);
+	void on_leaf(BnMContext_t& ctx);
+	// Replays path in ctx (from the root) and searches the subtree below it
+	void run_subtree(BnMContext_t& ctx, MASPInput* input, const std::vector<int>& path);
+	// Should the child at depth next_i be handed to the pool instead of searched right away?
+	bool spawn_child(int next_i);
+	// Best-first search from the root on ctx, stops at the target gap
+	void run_best_first(BnMContext_t& ctx, MASPInput* input);
+	// Prints the bound, incumbent and gap of the search with the number of open nodes
+	void report_gap(double bound);
+	/*
+	 * Reads the --checkpoint file into m_checkpoint when resuming. Returns false if there
+	 * is nothing to resume, fails hard if the checkpoint belongs to another search.
+	 */
+	bool load_checkpoint(MASPInput* input);
+	// Saves where ctx is (called from on_node()), or that the search is done, with the incumbent and counters
+	void save_checkpoint(BnMContext_t& ctx, bool done);
 	// Counts the number of recursive states required to iterate through (just FYI)
 	long int countRecursiveStates(std::vector<BnMAgent_t>& agents);
-	// Takes balanced matching index and converts it into the corresponding agent's index.
-	// Returns -1 if this is a phantom
-	int get_agent(int i, int N);
-	// Takes balanced matching index and converts it into the corresponding task's index
-	int get_task(int bal_j, int M, int a_f, std::vector<int>& d_j);
-	// Determines if this is a floating task
-	bool floating_task(int bal_j, int M, int a_f, std::vector<int>& d_j);
-
-	// Best found solution
-	double fGlobalProbSuccess;
+	// Determines if the unassigned agents can still cover the remaining demand once the agent at depth i took task
+	bool matching_exists(BnMContext_t& ctx, MASPInput* input, int i, int task);
+	// Hopcroft-Karp phase: layers the unassigned agents by alternating BFS from the unmatched ones. Returns true if a task with spare demand is reachable
+	bool hk_layers(BnMContext_t& ctx, const std::vector<int>& demand, const std::vector<int>& match);
+	// Hopcroft-Karp augment: finds a layered alternating path from free agent k to spare demand and flips it
+	bool hk_augment(BnMContext_t& ctx, int k, const std::vector<int>& demand, std::vector<int>& match);
+	// Takes agent k off task j in the Hopcroft-Karp workspace
+	void removeTaskAgent(BnMContext_t& ctx, int j, int k);
+
+	// Best found solution, shared by all search threads (bGlobalX_ij is guarded by m_incumbentMutex)
+	std::atomic<double> fGlobalProbSuccess;
 	bool** bGlobalX_ij;
-	// Performance statistics
-	long int nInvalidCount;
-	long int nPruningCount;
+	std::mutex m_incumbentMutex;
+
+	// Tasks each agent can do
+	std::vector<std::vector<int>> m_vvCanDo;
+
+	// Parallel search: one context per thread, the pool and the depth down to which every node is a task
+	std::vector<std::unique_ptr<BnMContext_t>> m_vContexts;
+	WorkStealingPool m_pool;
+	bool m_bParallel;
+	int m_nSplitDepth;
+
+	// Best-first search: open nodes, the memory they hold and when the gap was last printed
+	bool m_bBestFirst;
+	std::priority_queue<BnMOpen_t> m_frontier;
+	size_t m_nFrontierBytes;
+	std::chrono::steady_clock::time_point m_start;
+	std::chrono::steady_clock::time_point m_lastReport;
+
+	// Checkpointing of the serial depth-first search: is it on, what was saved or read (the
+	// input, options and agent order are set once per solve) and when the next one is due
+	bool m_bCheckpoint;
+	Checkpoint m_checkpoint;
+	std::chrono::steady_clock::time_point m_nextCheckpoint;
 
-	// Poisson Binomial helper
-	PoissonBinomial m_PoissonB;
+	// Searched states for dominance pruning (--dominance), serial depth-first search only
+	bool m_bDominance;
+	TranspositionTable m_table;
 };
@@ -18,16 +18,10 @@
 #include "Utilities.h"
 #include "MASPSolver.h"
 #include "MASP_MatchGS.h"
+#include "SearchEngine.h"
 
 #define DEBUG_MASP_FC	DEBUG || 0
 
-// Sort agents by branching factor
-#define SORT_AGENTS		1
-// Allow the algorithm to prune branches
-#define PRUNING			1
-// Give the algorithm a heuristic start
-#define HEURISTIC_START	1
-
 struct FastAgent_t {
 	int branchFactor;
 	int agent_i;
@@ -59,27 +53,32 @@ struct FastAgent_t {
 
 
 
-class MASP_FastComp : public MASPSolver {
+class MASP_FastComp : public MASPSolver, public SearchHooks {
 public:
 	MASP_FastComp();
 
 	void Solve(MASPInput* input, I_solution* I_final);
+	// Symmetry within a tolerance only gives an optimum up to it
+	bool IsExact() override {return !(m_options.bSymmetry && m_options.fSymmetryTol > 0);}
 
 protected:
 private:
-	void assign_next(MASPInput* input, int i, bool** x_ij, I_solution* I_crnt, std::vector<FastAgent_t>& agentMap);
-	// Determine if this is a valid solution
-	bool valid_solution(MASPInput* input, bool** x_ij);
+	// Search hooks: count the node and check the clock, prune children, score complete assignments
+	bool OnNode(SearchEngine& engine) override;
+	bool OnAssign(SearchEngine& engine, int i, int j) override;
+	void OnLeaf(SearchEngine& engine) override;
 	// Counts the number of recursive states required to iterate through (just FYI)
 	long int countRecursiveStates(std::vector<FastAgent_t>& agents);
 
 	// Best found solution
 	double fGlobalProbSuccess;
 	bool** bGlobalX_ij;
-	// Performance statistics
-	long int nInvalidCount;
-	long int nPruningCount;
 
 	// Poisson Binomial helper
 	PoissonBinomial m_PoissonB;
+	// Walks the agents in sorted order
+	SearchEngine m_engine;
+	// Searched states for dominance pruning (--dominance)
+	bool m_bDominance;
+	TranspositionTable m_table;
 };
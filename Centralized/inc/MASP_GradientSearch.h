@@ -24,7 +24,7 @@ public:
 
 	void Solve(MASPInput* input, I_solution* I_final);
 	// Gets the number of times the algorithm ran
-	int getIterations() {return iterationCount;}
+	int getIterations() override {return iterationCount;}
 
 protected:
 private:
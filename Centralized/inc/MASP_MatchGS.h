@@ -16,9 +16,11 @@
 #include <limits>
 #include <list>
 #include <time.h>
+#include <chrono>
 
 #include "Utilities.h"
 #include "MASPSolver.h"
+#include "IncrementalLAP.h"
 
 #define DEBUG_MASP_MCHGS	DEBUG || 0
 
@@ -29,17 +31,20 @@ public:
 
 	void Solve(MASPInput* input, I_solution* I_final);
 	// Gets the number of times the algorithm ran
-	int getIterations() {return iterationCount;}
+	int getIterations() override {return iterationCount;}
 
 protected:
 private:
-	/*
-	 * Takes cost matrix index and converts it into the corresponding task's index. This assumes
-	 * that the entries in the matrix are in order based on minimum required agents per task
-	 * (e.g. 1.1 1.2 2.1 2.2 .. x.1 x.2 ..). It will return -1 if the given index is past the
-	 * minimum number of agents required over tasks (in x range from example).
-	 */
-	int get_task(int index, MASPInput* input);
+	// Fills costMatrix (NxN where cost[i][j] is the prob. that agent i fails at slot j)
+	void buildCostMatrix(MASPInput* input, BalancedModel& model, std::vector<std::vector<double>>& costMatrix);
+	// Sets x_ij to the agent-task assignments of the slot matching assignment
+	void extract(MASPInput* input, BalancedModel& model, const std::vector<int>& assignment, bool** x_ij);
+	// Runs the gradient search from x_ij until no agent wants to move, returns the final Z
+	double descend(MASPInput* input, bool** x_ij);
+	// Tries the matching with each agent kept off its task in x_ij, keeps improvements on Z. Returns the best Z
+	double rematch(MASPInput* input, BalancedModel& model, bool** x_ij, double Z);
 
 	int iterationCount;
+	// Matching re-solved by rematch()
+	IncrementalLAP m_lap;
 };
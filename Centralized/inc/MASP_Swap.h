@@ -38,17 +38,10 @@ private:
 	// Number of participants for SMP
 	int np;
 
-	// Takes balanced matching index and converts it into the corresponding task's index
-	int get_task(int j, MASPInput* input);
-	// Takes balanced matching index and converts it into the corresponding agent's index.
-	// Returns -1 if this is a phantom
-	int get_agent(int i, MASPInput* input);
-	// Determines if this is a floating task
-	bool floating_task(int j, MASPInput* input);
-	int resolve_task(int jj, MASPInput* input);
 	void single_swap(I_solution* I_crnt, MASPInput* input, I_solution& outputSoln);
 	void two_swap(I_solution* I_crnt, MASPInput* input, I_solution& outputSoln);
 	void three_swap(I_solution* I_crnt, MASPInput* input, I_solution& outputSoln);
 	void four_swap(I_solution* I_crnt, MASPInput* input, I_solution& outputSoln);
+	void best_improvement(I_solution* I_crnt, MASPInput* input, I_solution& outputSoln);
 
 };
@@ -33,11 +33,4 @@ protected:
 private:
 	// Runs Monti Carlo Simulation to determine the probability that the agents in I_j complete task j
 	double monteSim(MASPInput* input, std::vector<int>& I_j, int j, I_solution* I_final);
-	/*
-	 * Takes cost matrix index and converts it into the corresponding task's index. This assumes
-	 * that the entries in the matrix are in order based on minimum required agents per task
-	 * (e.g. 1.1 1.2 2.1 2.2 .. x.1 x.2 ..). It will return -1 if the given index is past the
-	 * minimum number of agents required over tasks (in x range from example).
-	 */
-	int get_task(int index, MASPInput* input);
 };
@@ -0,0 +1,73 @@
+/*
+ * MASP_TypeDP.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Exact solver for fleets made of a few agent types. Agents with the same
+ * capabilities and p_ij (see MASPInput::AgentClasses()) are interchangeable, so P_s of a
+ * task only depends on how many agents of each type it gets, and Z is the product of
+ * those P_s over the tasks. The solver tabulates P_s of every task for every count vector
+ * of the types that can do it, then combines the tasks one at a time by dynamic
+ * programming over the agents still left:
+ *
+ *   V_M(0) = 1, V_M(r) = 0 for r != 0 (every agent gets a task)
+ *   V_j(r) = max_{c <= r} P_j(c)*V_{j+1}(r - c)
+ *
+ * where r and c are count vectors, stored as mixed-radix indices (digit t runs 0..n_t).
+ * The optimum is V_0(n) and the counts are recovered by walking the tasks forward. Work
+ * and memory grow with prod(n_t + 1) instead of with the number of assignments, so this
+ * solves large fleets with few types. With --symmetry-tol above 0 agents within the
+ * tolerance share a type and the result is optimal up to that tolerance.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <vector>
+
+#include "Utilities.h"
+#include "MASPSolver.h"
+#include "MASP_MatchGS.h"
+
+#define DEBUG_MASP_TYPEDP	DEBUG || 0
+// Most table entries (P_s and DP values over all tasks) the solver allocates
+#define TYPEDP_MAX_ENTRIES	(1 << 25)
+
+class MASP_TypeDP : public MASPSolver {
+public:
+	MASP_TypeDP();
+
+	void Solve(MASPInput* input, I_solution* I_final);
+	// Types merged within a tolerance only give an optimum up to it
+	bool IsExact() override {return m_options.fSymmetryTol == 0;}
+
+protected:
+private:
+	/*
+	 * Fills m_vvP[j] with P_s of task j for every count vector of the types that can do j.
+	 * Returns false if the solver was asked to stop.
+	 */
+	bool taskTable(MASPInput* input, int j);
+	// Best P_j(c)*V_{j+1}(r - c) over c <= r, the c it was found at goes in bestC (-1 if every split gives 0)
+	double bestSplit(int j, int r, int* bestC);
+
+	// Agent types: number of agents of each, one agent standing for it and the stride of its digit in a count vector
+	int m_nTypes;
+	std::vector<int> m_vTypeCount;
+	std::vector<int> m_vTypeAgent;
+	std::vector<int> m_vStride;
+	// Number of count vectors, prod(n_t + 1)
+	int m_nVectors;
+	// Types that can do each task
+	std::vector<std::vector<int>> m_vvTaskTypes;
+	// Per task: P_s for each count vector (0 where a type that can't do the task has agents)
+	std::vector<std::vector<double>> m_vvP;
+	// Per task j = 0..M: V_j for each count vector of agents left
+	std::vector<std::vector<double>> m_vvV;
+	// Odometer workspace of bestSplit() and taskTable(): digit of each type and its limit
+	std::vector<int> m_vDigit;
+	std::vector<int> m_vLimit;
+	std::vector<double> m_vPMF;
+	PoissonBinomial m_PoissonB;
+};
@@ -5,18 +5,56 @@
  * On: 			Oct 3, 2023
  *
  * Description: Algorithm to solve the MAS Problem to completion (i.e. finds
- * the optimal solution through exhaustive search)
+ * the optimal solution through exhaustive search). Assignments are enumerated in
+ * reflected mixed-radix Gray code order, where digit i is the task of agent i among the
+ * tasks it can do, so two consecutive assignments only move one agent. P_s of each task
+ * is kept from the PMF of its successes below d_j, which is updated by removing the agent
+ * from its old task and adding it to the new one, so each assignment is scored in
+ * O(d_j + M) instead of by a full benchmark. The assignments are split into chunks by
+ * the tasks of a few agents, which the threads of a work-stealing pool enumerate.
  */
 
 #pragma once
 
 #include <math.h>
 #include <vector>
+#include <memory>
 
 #include "Utilities.h"
 #include "MASPSolver.h"
+#include "WorkStealingPool.h"
 
 #define DEBUG_MASPC		DEBUG || 0
+// Chunks per thread when enumerating in parallel
+#define COMP_CHUNKS_PER_THREAD	16
+// Assignments enumerated between two calls to StopRequested()
+#define COMP_STOP_PERIOD	1024
+// Updates of the PMF of a task before it is rebuilt from its agents, bounds the rounding drift
+#define COMP_REFRESH_PERIOD	64
+
+
+// Enumeration state of one thread
+struct CompContext_t {
+	// Task of each agent, the agents on each task and where each agent is in that list
+	std::vector<int> vTask;
+	std::vector<std::vector<int>> vvAgents;
+	std::vector<int> vSlot;
+	// Per task: P(X_j = k) for k < d_j, P_s and the updates since the PMF was rebuilt
+	std::vector<std::vector<double>> vvPMF;
+	std::vector<double> vP;
+	std::vector<int> vUpdates;
+	// Tasks with fewer agents than d_j
+	int nUncovered;
+	// Gray code: digit, direction and focus pointer of each enumerated agent
+	std::vector<int> vDigit;
+	std::vector<int> vDir;
+	std::vector<int> vFocus;
+	// Best assignment found by the thread and the chunk it was found in
+	double fBest;
+	std::vector<int> vBest;
+	int nBestChunk;
+	SolverStats stats;
+};
 
 
 class MASPComp : public MASPSolver {
@@ -24,14 +62,24 @@ public:
 	MASPComp();
 
 	void Solve(MASPInput* input, I_solution* I_final);
+	bool IsExact() override {return true;}
 
 protected:
 private:
-	void assign_next(MASPInput* input, int i, bool** x_ij, I_solution* I_crnt);
-	// Determine if this is a valid solution
-	bool valid_solution(MASPInput* input, bool** x_ij);
+	// Enumerates every assignment of chunk on ctx
+	void enumerate(CompContext_t& ctx, MASPInput* input, int chunk);
+	// Puts agent i on task j, removing it from its current task first (if any)
+	void move(CompContext_t& ctx, MASPInput* input, int i, int j);
+	// Rebuilds the PMF and P_s of task j from the agents on it
+	void rebuild(CompContext_t& ctx, MASPInput* input, int j);
 
-	// Best found solution
-	double fProbSuccess;
-	bool** bX_ij;
+	// Tasks each agent can do
+	std::vector<std::vector<int>> m_vvTasks;
+	// Agents whose tasks are enumerated in Gray code order, and agents that split the assignments into chunks
+	std::vector<int> m_vGray;
+	std::vector<int> m_vSplit;
+	int m_nChunks;
+	// One context per thread
+	std::vector<std::unique_ptr<CompContext_t>> m_vContexts;
+	WorkStealingPool m_pool;
 };
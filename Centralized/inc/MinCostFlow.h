@@ -0,0 +1,69 @@
+/*
+ * MinCostFlow.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Min-cost flow by successive shortest paths. Each augmentation runs
+ * Dijkstra on costs reduced by node potentials, so every cost given to AddEdge() must
+ * be non-negative. Used by the balanced-matching solvers to solve the agent/task
+ * transportation problem directly, instead of expanding each task into d_j + a_f
+ * identical columns of an assignment matrix.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+#include <queue>
+#include <limits>
+
+#include "defines.h"
+
+#define DEBUG_MCF	DEBUG || 0
+
+// How the balanced-matching solvers match agents to tasks (see SolverOptions)
+enum {
+	e_Match_Flow = 0,
+	e_Match_Matrix = 1,
+};
+
+class MinCostFlow {
+public:
+	MinCostFlow();
+	~MinCostFlow();
+
+	// Clears the graph and creates n nodes, numbered 0 to n-1
+	void Reset(int n);
+	// Adds edge u -> v with the given capacity and non-negative cost, returns the edge's id
+	int AddEdge(int u, int v, int capacity, double cost);
+	/*
+	 * Sends up to maxFlow units from s to t at minimum cost. Returns the amount sent,
+	 * *cost is set to the total cost of the flow.
+	 */
+	int Solve(int s, int t, int maxFlow, double* cost);
+	// Flow on edge id after Solve()
+	int Flow(int id);
+
+private:
+	struct Edge_t {
+		int to;
+		int cap;
+		double cost;
+	};
+
+	// Runs Dijkstra from s until t is settled, fills m_vDist/m_vPrevEdge. Returns false if t is unreachable
+	bool shortestPath(int s, int t);
+
+	// Edges are stored in pairs, edge id^1 is the residual of edge id
+	std::vector<Edge_t> m_vEdges;
+	std::vector<std::vector<int>> m_vAdj;
+	// Node potentials, keep the reduced costs non-negative between augmentations
+	std::vector<double> m_vPotential;
+	// Dijkstra workspace
+	std::vector<double> m_vDist;
+	std::vector<int> m_vPrevEdge;
+	std::vector<bool> m_vDone;
+};
@@ -0,0 +1,66 @@
+/*
+ * MoveGainTable.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Maintains the change in log(Z) from moving any agent i to any task j
+ * on top of the move cache in Solver. The gain of a move splits into the gain of
+ * adding i to j plus the gain of removing i from its current task, so a move only
+ * refreshes the columns of the two affected tasks and the rows of their members.
+ * A tournament tree over all N*M entries gives the best move at the root.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "defines.h"
+#include "MASPInput.h"
+
+#define DEBUG_MOVEGAIN	DEBUG || 0
+
+class Solver;
+
+class MoveGainTable {
+public:
+	MoveGainTable();
+	~MoveGainTable();
+
+	// Builds the table from the solver's current move cache (see Solver::InitDeltaCache)
+	void Build(MASPInput* input, Solver* solver);
+	/*
+	 * Refreshes the table after agent i moved from from_j to to_j. Call this after
+	 * Solver::ApplyMove() so that the cache already reflects the move.
+	 */
+	void OnMove(MASPInput* input, Solver* solver, int i, int from_j, int to_j);
+	// Gets the best move in the table. Returns false if there are no legal moves.
+	bool BestMove(int* i, int* j, double* gain);
+	// Gets the change in log(Z) from moving agent i to task j
+	double Gain(int i, int j);
+
+private:
+	// Re-computes the gain of adding each agent to task j
+	void refreshColumn(MASPInput* input, Solver* solver, int j);
+	// Re-computes the gain of removing agent i from its task and pushes its row into the tree
+	void refreshRow(MASPInput* input, Solver* solver, int i);
+	// Sets a single entry in the tournament tree
+	void setEntry(int i, int j, double gain);
+	// log() that maps P_s = 0 to a large negative number instead of -inf
+	double safeLog(double x);
+
+	int m_N;
+	int m_M;
+	// Gain of adding agent i to task j (N*M)
+	std::vector<double> m_vAddGain;
+	// Gain of removing agent i from its current task (N)
+	std::vector<double> m_vRemoveGain;
+	// Agents currently on each task
+	std::vector<std::vector<int>> m_vMembers;
+	// Tournament tree, leaves hold i*M + j, internal nodes the index of the best leaf below
+	int m_nLeaves;
+	std::vector<double> m_vLeafGain;
+	std::vector<int> m_vTree;
+};
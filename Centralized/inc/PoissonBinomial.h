@@ -16,6 +16,7 @@
 #include <complex>
 #include <sstream>
 #include <fstream>
+#include <algorithm>
 
 #include "defines.h"
 
@@ -42,6 +43,27 @@ public:
 	 */
 	double P_s(int d_j, int n, std::vector<double>& p_values);
 
+	/*
+	 * Builds the full PMF of the Poisson-Binomial distribution for the trials in p_values by
+	 * convolving one trial at a time. pmf[k] is the probability of exactly k successes and
+	 * pmf has size |p_values| + 1. This is O(n^2) but avoids the complex arithmetic of PMF().
+	 */
+	void BuildPMF(std::vector<double>& p_values, std::vector<double>& pmf);
+	// Adds a single trial with probability p to an existing PMF (O(n))
+	void AddTrial(std::vector<double>& pmf, double p);
+	// Removes a single trial with probability p from an existing PMF (O(n))
+	void RemoveTrial(std::vector<double>& pmf, double p);
+	// Probability of d_j or more successes given a PMF (O(n))
+	double Tail(int d_j, std::vector<double>& pmf);
+	// Probability of d_j or more successes after adding a trial with probability p (O(n), pmf is unchanged)
+	double TailWith(int d_j, std::vector<double>& pmf, double p);
+	// Probability of d_j or more successes after removing a trial with probability p (O(n), pmf is unchanged)
+	double TailWithout(int d_j, std::vector<double>& pmf, double p);
+
+	// Number of PMF(), BuildPMF() and Tail() evaluations since the last ResetCalls()
+	long int Calls() {return m_nCalls;}
+	void ResetCalls() {m_nCalls = 0;}
+
 private:
 	// Calculates P_j for the agents in I_j
 	double P_j(std::vector<int>& I_j, int j);
@@ -53,4 +75,7 @@ private:
 	void combination(int* a, int reqLen, int start, int currLen, bool* check, int len, std::vector<std::vector<int>>& combos);
 	// Runs Monti Carlo Simulation to determine the probability that the agents in I_j complete task j
 	double monteSim(int j);
+
+	// Evaluation counter (see Calls())
+	long int m_nCalls;
 };
@@ -0,0 +1,239 @@
+/*
+ * SearchEngine.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Depth-first search shared by the exact solvers. Depth i assigns one agent
+ * to one of the tasks it can do. Agents are taken in an order given by the solver, or
+ * (with dynamic ordering) the node picks the unassigned agent that can do the task with
+ * the least spare supply of agents. Tasks are tried in index order, or by their gain in
+ * the optimistic bound. The engine walks the
+ * tree with an explicit stack and keeps the task of each agent, the number of agents on
+ * each task and the demand still uncovered, all updated in O(1) on assign and undo. The
+ * solver decides what to prune and what to do at a leaf through SearchHooks. Optionally
+ * the engine also keeps the optimistic bound (every unassigned agent counts towards every
+ * task it can do) as one Poisson-Binomial PMF per task, changed by one agent per level
+ * and restored from a trail on backtrack. Nothing is allocated once Init() returns.
+ * Agents can be grouped into classes of interchangeable agents, in which case only the
+ * assignments where the agents of a class take non-decreasing tasks (in search order) are
+ * searched, one per way of splitting each class across the tasks.
+ *
+ * With propagation on, each node first looks for moves the uncovered demand forces: a task
+ * whose uncovered demand equals the unassigned agents that can do it needs all of them,
+ * and when the unassigned agents exactly cover the demand left (no slack) an agent with
+ * one task with uncovered demand left must take it. The node then branches on a forced
+ * agent with that task as its only child, so forced moves go down the tree one per level
+ * and are undone by backtracking like any other assignment (with static ordering the agent
+ * moved up to the depth goes back on Pop()). Without slack, nodes only try tasks with
+ * uncovered demand. A node where some task lacks supply, the demand exceeds the agents
+ * left, an agent is needed by two tasks or has no task it can take gets no children.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <algorithm>
+
+#include "defines.h"
+#include "MASPInput.h"
+#include "PoissonBinomial.h"
+
+#define DEBUG_SEARCH	DEBUG || 0
+// SearchEngine::m_vForced of a node that propagation showed can't be completed
+#define PROPAGATE_FAIL	-2
+
+// Order in which branch-and-match visits open nodes (SolverOptions::nSearch)
+enum {
+	e_Search_DepthFirst = 0,
+	e_Search_BestFirst = 1,
+};
+
+// Which agent a node branches on (SolverOptions::nVarOrder)
+enum {
+	e_VarOrder_Static = 0,
+	e_VarOrder_Dynamic = 1,
+};
+
+// Order in which a node tries the tasks of its agent (SolverOptions::nValueOrder)
+enum {
+	e_ValueOrder_Index = 0,
+	e_ValueOrder_Gain = 1,
+};
+
+class SearchEngine;
+
+// What a solver plugs into SearchEngine::Run()
+class SearchHooks {
+public:
+	virtual ~SearchHooks() {}
+	// Called on entering every node, leaves included. Return false to stop the whole search.
+	virtual bool OnNode(SearchEngine& engine) = 0;
+	// Called right after the agent at depth i took task j. Return false to prune that child.
+	virtual bool OnAssign(SearchEngine& engine, int i, int j) {return true;}
+	// Called at every complete assignment
+	virtual void OnLeaf(SearchEngine& engine) = 0;
+	// Called right after SearchEngine::Restore() replayed task j at depth i
+	virtual void OnReplay(SearchEngine& engine, int i, int j) {}
+};
+
+class SearchEngine {
+public:
+	SearchEngine();
+	~SearchEngine();
+	SearchEngine(const SearchEngine&) = delete;
+	SearchEngine& operator=(const SearchEngine&) = delete;
+
+	/*
+	 * Sets up a search over input that assigns agent order[i] at depth i (static ordering).
+	 * With bound set the engine also keeps the optimistic bound, evaluated with poissonB.
+	 */
+	void Init(MASPInput* input, const std::vector<int>& order, bool bound, PoissonBinomial* poissonB);
+	/*
+	 * Treats agents with the same agentClass[i] as interchangeable (see MASPInput::AgentClasses()),
+	 * to be called after Init(). Returns the number of agents tied to an earlier agent.
+	 */
+	int SetClasses(const std::vector<int>& agentClass);
+	/*
+	 * Selects the agent and task orders (e_VarOrder_*, e_ValueOrder_*), to be called after
+	 * Init(). With dynamic agent ordering, ties go to the agent first in Init()'s order.
+	 */
+	void SetOrdering(int varOrder, int valueOrder);
+	// Turns constraint propagation at each node on or off, to be called after Init()
+	void SetPropagation(bool propagate);
+	// Searches the subtree below the current state. Returns false if the hooks stopped it.
+	bool Run(SearchHooks& hooks);
+	/*
+	 * Saves where the search is, to be called from OnNode(): the tasks taken at depths
+	 * 0..Depth()-1 and the index of the next child each of those nodes tries.
+	 */
+	void Save(std::vector<int>& path, std::vector<int>& next);
+	/*
+	 * Rebuilds a state saved by Save() from the root: replays path, calling hooks.OnReplay()
+	 * after each step, and sets where each node on it continues. Returns false if the state
+	 * doesn't fit this search (different input or options).
+	 */
+	bool Restore(SearchHooks& hooks, const std::vector<int>& path, const std::vector<int>& next);
+	// Continues a search restored by Restore() until the whole tree is done. Returns false if the hooks stopped it.
+	bool Resume(SearchHooks& hooks);
+	// Assigns the agent at the current depth to task j and moves one level down
+	void Push(int j);
+	// Undoes the last Push()
+	void Pop();
+
+	MASPInput* Input() {return m_pInput;}
+	int N() {return m_nN;}
+	int M() {return m_nM;}
+	int Depth() {return m_nDepth;}
+	// Agent assigned at depth i (the one picked for the current node at i = Depth())
+	int Agent(int i) {return m_vOrder[i];}
+	// Task of agent, -1 if not assigned yet
+	int Task(int agent) {return m_vTask[agent];}
+	// Tasks the agent at depth i can do, in task order
+	const std::vector<int>& CanDo(int i) {return m_vvAgentCanDo[m_vOrder[i]];}
+	// The current assignment as an N x M matrix (for the benchmark functions)
+	bool** X() {return m_pX;}
+	// Agents on task j
+	int Count(int j) {return m_vCount[j];}
+	// Demand of task j that is not covered yet and its sum over all tasks
+	int Remaining(int j) {return m_vRemaining[j];}
+	int Required() {return m_nRequired;}
+	// Agents left to assign
+	int Unassigned() {return m_nN - m_nDepth;}
+	// Does the current assignment meet every d_j?
+	bool Covered() {return m_nRequired == 0;}
+	// Fills path with the tasks taken at depths 0..Depth()-1
+	void Path(std::vector<int>& path);
+	// Nodes that propagation gave a single forced child, and nodes it showed can't be completed
+	long int Forced() {return m_nForced;}
+	long int Failed() {return m_nFailed;}
+
+	/*
+	 * Optimistic bound of the current state, to be called from OnAssign(): agents above the
+	 * current depth keep their tasks and every unassigned agent counts towards every task it
+	 * can do. Costs O(|CanDo|) since the parent node already computed its tails without the
+	 * agent it assigns.
+	 */
+	double Bound();
+
+private:
+	// Enters the node at the current depth, returns false if the hooks stopped the search
+	bool enter(SearchHooks& hooks);
+	// Picks the agent of the node at the current depth and the tasks it tries
+	void prepare();
+	// Searches on from the node just entered until the subtree at depth base is done
+	bool search(SearchHooks& hooks, int base);
+	// Picks the agent of the node at the current depth (dynamic ordering or propagation)
+	void select();
+	// Picks the agent of the node at the current depth (dynamic ordering)
+	void choose();
+	/*
+	 * Looks for a move the uncovered demand forces at the current depth. Returns false if
+	 * the state can't be completed, otherwise puts a forced agent and its task in agent and
+	 * task (-1 if nothing is forced).
+	 */
+	bool propagate(int* agent, int* task);
+	// Fills the tasks the node at the current depth tries, in the order it tries them
+	void orderTasks();
+	// Brings the bound PMFs up to the current depth and prepares the bounds of its children
+	void boundEnter();
+	// Takes the agent at depth d off every task but its own in the bound, saving what changes on the trail
+	void boundApply(int d);
+	// Undoes boundApply(d) from the trail
+	void boundUndo(int d);
+
+	MASPInput* m_pInput;
+	int m_nN;
+	int m_nM;
+	int m_nDepth;
+	std::vector<int> m_vOrder;
+	// Tasks each agent can do, in task order
+	std::vector<std::vector<int>> m_vvAgentCanDo;
+	std::vector<int> m_vTask;
+	std::vector<int> m_vCount;
+	std::vector<int> m_vRemaining;
+	int m_nRequired;
+	bool** m_pX;
+	// Explicit stack: tasks to try at depth i and the next one to try
+	std::vector<std::vector<int>> m_vvVisit;
+	std::vector<int> m_vNext;
+	// Per agent: the last agent of the same class before it in Init()'s order, or -1
+	std::vector<int> m_vSame;
+
+	// Agent and task orders (see SetOrdering())
+	int m_nVarOrder;
+	int m_nValueOrder;
+	// Position of each agent in Init()'s order
+	std::vector<int> m_vRank;
+	// Per depth: has the agent of the node there been picked?
+	std::vector<bool> m_vChosen;
+	// Unassigned agents that can do each task
+	std::vector<int> m_vSupply;
+	// Gain of each task of the current node (orderTasks() workspace)
+	std::vector<double> m_vGain;
+
+	// Constraint propagation (see SetPropagation())
+	bool m_bPropagate;
+	// Per depth: task forced on the agent, -1 if none, PROPAGATE_FAIL if the node can't be completed
+	std::vector<int> m_vForced;
+	// Per depth: position in m_vOrder the forced agent was moved up from (static ordering), -1 if none
+	std::vector<int> m_vMoved;
+	long int m_nForced;
+	long int m_nFailed;
+
+	// Optimistic bound (see Bound()): PMF and tail of each task
+	bool m_bBound;
+	PoissonBinomial* m_pPoissonB;
+	std::vector<std::vector<double>> m_vvPMF;
+	std::vector<double> m_vTail;
+	// Number of depths whose agent has been taken off its other tasks in the PMFs
+	int m_nApplied;
+	// Per depth d: product of the tails of the tasks the agent can't do, and the tails of the tasks it can do without it
+	std::vector<double> m_vOther;
+	std::vector<std::vector<double>> m_vvWithout;
+	// Per depth d: PMFs and tails changed by boundApply(d), indexed like CanDo(d)
+	std::vector<std::vector<std::vector<double>>> m_vvvTrail;
+	std::vector<std::vector<double>> m_vvTrailTail;
+};
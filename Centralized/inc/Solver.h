@@ -15,20 +15,55 @@
 #include <vector>
 #include <cmath>
 #include <complex>
+#include <atomic>
+#include <chrono>
 
 #include "I_solution.h"
 #include "MASPInput.h"
 #include "PoissonBinomial.h"
+#include "SolverOptions.h"
+#include "SolverStats.h"
 #include "Utilities.h"
 
 #define DEBUG_SOLVER	0 || DEBUG
 
+// Number of StopRequested() calls between reads of the clock
+#define STOP_CHECK_PERIOD	64
+
+// Outcome of a deadline-bounded solve (see Solver::SolveWithin())
+struct SolveResult {
+	// The search ran to completion and the solver is exact, so the assignment is optimal
+	bool bOptimal;
+	// The solver stopped early because the deadline passed or it was cancelled
+	bool bStopped;
+	// Z of the returned assignment
+	double fZ;
+};
+
 class Solver {
 public:
 	Solver();
 	virtual ~Solver();
 
+	typedef std::chrono::steady_clock Clock;
+
 	virtual void Solve(MASPInput* input, I_solution* I_final) = 0;
+	/*
+	 * Runs Solve() but stops once deadline passes or *cancel is set (cancel may be NULL).
+	 * Solvers check for this at cheap points and then return their best incumbent in
+	 * I_final. Pass Clock::time_point::max() for no deadline.
+	 */
+	SolveResult SolveWithin(MASPInput* input, I_solution* I_final, Clock::time_point deadline, std::atomic<bool>* cancel);
+	// True if a completed Solve() is guaranteed to find an optimal assignment
+	virtual bool IsExact() {return false;}
+	// Counters from the last call to SolveWithin()
+	const SolverStats& GetStats() {return m_stats;}
+
+	// Sets the run-time options used by the next call to Solve()
+	virtual void SetOptions(const SolverOptions& options) {m_options = options;}
+	const SolverOptions& GetOptions() {return m_options;}
+	// Number of search iterations of the last solve, -1 if the solver does not iterate
+	virtual int getIterations() {return -1;}
 
 	/*
 	 * Determines the probability of mission success given the input problem
@@ -40,7 +75,49 @@ public:
 	 * and assignment I_sol. Assumes that I_sol contains a valid solution.
 	 */
 	double BenchmarkCF(MASPInput* input, bool** x_ij);
+	// Same as above but evaluates with poissonB, so search threads can each use their own
+	double BenchmarkCF(MASPInput* input, bool** x_ij, PoissonBinomial& poissonB);
+
+	/*
+	 * Move-evaluation API. InitDeltaCache() records the task of each agent in x_ij and caches
+	 * the success-count PMF and P_s of every task. deltaZ() then returns the change in Z from
+	 * moving agent i from from_j to to_j (either may be -1 for "no task") by re-evaluating only
+	 * those two tasks, which is O(n) instead of the O(M*n^3) of BenchmarkCF(). ApplyMove()
+	 * commits a move to the cache. The caller is responsible for keeping its own x_ij in sync.
+	 */
+	void InitDeltaCache(MASPInput* input, bool** x_ij);
+	double deltaZ(MASPInput* input, int i, int from_j, int to_j);
+	void ApplyMove(MASPInput* input, int i, int from_j, int to_j);
+	// Z of the cached assignment
+	double CachedZ() {return m_fDeltaZ;}
+	// P_s of task j in the cached assignment
+	double CachedPs(int j) {return m_vDeltaPs.at(j);}
+	// Number of agents on task j in the cached assignment
+	int CachedNj(int j) {return static_cast<int>(m_vDeltaPMF.at(j).size()) - 1;}
+	// Task of agent i in the cached assignment (-1 if unassigned)
+	int CachedTask(int i) {return m_vDeltaTask.at(i);}
+	// P_s of task j if agent i joined it
+	double PsWith(MASPInput* input, int i, int j);
+	// P_s of task j if agent i left it
+	double PsWithout(MASPInput* input, int i, int j);
+
 protected:
+	/*
+	 * Returns true once the deadline of SolveWithin() has passed or the solve was cancelled.
+	 * Only reads the clock every STOP_CHECK_PERIOD calls so it can be called once per node.
+	 * Safe to call from several search threads.
+	 */
+	bool StopRequested();
+	/*
+	 * Same as StopRequested() but reads the clock on every call, for check points that are
+	 * far apart (e.g. the head of a loop whose body runs for a long time)
+	 */
+	bool DeadlinePassed();
+	// True if the last call to StopRequested() asked the solver to stop
+	bool Stopped() {return m_bStopped;}
+	// Stops the solve as if the deadline had passed (the result is not proven optimal)
+	void RequestStop() {m_bStopped = true;}
+
 	bool wholeNumber(double);
 	// Calculates P_j for the agents in I_j
 	double P_j(MASPInput* input, std::vector<int>& I_j, int j);
@@ -52,4 +129,31 @@ protected:
 	void combination(int* a, int reqLen, int start, int currLen, bool* check, int len, std::vector<std::vector<int>>& combos);
 
 	PoissonBinomial m_poissonBinomial;
+	// Run-time options
+	SolverOptions m_options;
+	// Search statistics, reset by SolveWithin()
+	SolverStats m_stats;
+
+private:
+	// Re-computes the cached Z from the cached P_s values
+	void updateDeltaZ();
+
+	// Deadline and cancellation flag of the current solve
+	bool m_bHasDeadline;
+	Clock::time_point m_deadline;
+	std::atomic<bool>* m_pCancel;
+	std::atomic<bool> m_bStopped;
+	std::atomic<long int> m_nStopChecks;
+
+	// Task assigned to each agent in the move cache (-1 if unassigned)
+	std::vector<int> m_vDeltaTask;
+	// Success-count PMF of each task in the move cache
+	std::vector<std::vector<double>> m_vDeltaPMF;
+	// P_s of each task in the move cache
+	std::vector<double> m_vDeltaPs;
+	// Product of the non-zero P_s values and the number of tasks with P_s = 0
+	double m_fDeltaNonZeroProd;
+	int m_nDeltaZeroTasks;
+	// Z of the cached assignment
+	double m_fDeltaZ;
 };
@@ -0,0 +1,89 @@
+/*
+ * SolverOptions.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Run-time tuning options shared by all solvers. Options are given on
+ * the command line as --name=value (or --name for true/false options) and are passed
+ * to a solver with Solver::SetOptions() before calling Solve().
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "defines.h"
+
+#define DEBUG_SOLVEROPTS	DEBUG || 0
+
+struct SolverOptions {
+	// Wall-clock time limit for a solve in seconds (0 = no limit)
+	double fTimeLimit;
+	// Number of worker threads a solver may use
+	int nThreads;
+	// Seed for the random number generator
+	unsigned int nSeed;
+	// Sort agents by branching factor in the exact solvers
+	bool bSortAgents;
+	// Agent and task order of the exact solvers' search (e_VarOrder_*, e_ValueOrder_* in SearchEngine.h)
+	int nVarOrder;
+	int nValueOrder;
+	// Allow the exact solvers to prune branches by bound
+	bool bPruning;
+	// Search one assignment per split of each class of interchangeable agents in the exact solvers
+	bool bSymmetry;
+	// Largest difference in p_ij for two agents to be interchangeable
+	double fSymmetryTol;
+	// Give the exact solvers a heuristic starting solution
+	bool bHeuristicStart;
+	// Run best-improvement local search in the gradient heuristics
+	bool bBestImprovement;
+	// Follow match-gs with its re-matching neighbourhood
+	bool bRematch;
+	// Linear assignment algorithm used by the matching-based solvers (e_Assign_* in Hungarian.h)
+	int nAssignment;
+	// How balanced-matching solvers match agents to tasks (e_Match_* in MinCostFlow.h)
+	int nMatching;
+	// Bound branch-and-match prunes with (e_Bound_* in LagrangianBound.h)
+	int nBound;
+	// Node order of branch-and-match (e_Search_* in SearchEngine.h)
+	int nSearch;
+	// Memory cap on the open nodes of a best-first search in MB, deeper nodes are searched depth-first
+	double fFrontierMB;
+	// Stop once (bound - incumbent)/bound is at most this (0 = prove optimality)
+	double fGap;
+	// Print the bound, incumbent and gap every this many seconds (0 = never)
+	double fGapReport;
+	// File the depth-first exact search saves its state to ("" = none), every this many seconds
+	std::string sCheckpoint;
+	double fCheckpointEvery;
+	// Continue the search saved in sCheckpoint instead of starting over
+	bool bResume;
+	// Prune states of the depth-first exact solvers that a searched state dominates, with a table of at most this many MB
+	bool bDominance;
+	double fTableMB;
+	// Apply the moves the uncovered demand forces at each node of the exact solvers
+	bool bPropagate;
+
+	SolverOptions();
+
+	/*
+	 * Parses every --name=value argument in argv into this object. Arguments that do not
+	 * start with "--" are returned in positional (argv[0] excluded). Returns false and
+	 * prints the problem if an option is unknown or has a bad value.
+	 */
+	bool Parse(int argc, char* argv[], std::vector<std::string>& positional);
+	// Prints the available options
+	static void PrintUsage(FILE* stream);
+	// Prints the options that are currently set
+	void Print(FILE* stream);
+
+private:
+	// Parses a true/false value, accepts 0/1/true/false
+	bool parseBool(const std::string& value, bool* out);
+};
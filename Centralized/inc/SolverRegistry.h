@@ -0,0 +1,58 @@
+/*
+ * SolverRegistry.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Maps algorithm identifiers (see e_Algo_* in defines.h) and short names
+ * to solver factories. Each solver registers itself from its own source file with
+ * REGISTER_SOLVER(), so adding a solver does not require touching main.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <functional>
+
+#include "Solver.h"
+
+#define DEBUG_SOLVERREG	DEBUG || 0
+
+class SolverRegistry {
+public:
+	typedef std::function<Solver*()> Factory;
+
+	// Gets the one registry shared by all solvers
+	static SolverRegistry& Instance();
+
+	// Adds a solver. Returns true so that it can be used to initialize a static.
+	bool Register(int id, const char* name, Factory factory);
+	// Creates solver id, returns NULL if there is no such solver
+	Solver* Create(int id);
+	/*
+	 * Creates a solver from either its identifier or its name. Returns NULL if there is
+	 * no such solver, otherwise *id is set to the solver's identifier.
+	 */
+	Solver* Create(const std::string& key, int* id);
+	// Prints all registered solvers
+	void PrintSolvers(FILE* stream);
+
+private:
+	SolverRegistry() {}
+
+	struct Entry_t {
+		int id;
+		std::string name;
+		Factory factory;
+	};
+
+	// Registered solvers, kept sorted by identifier
+	std::vector<Entry_t> m_vEntries;
+};
+
+// Registers solver CLASS under identifier ID and name NAME
+#define REGISTER_SOLVER(ID, NAME, CLASS) \
+	static bool registered_##CLASS = SolverRegistry::Instance().Register(ID, NAME, []() -> Solver* {return new CLASS();})
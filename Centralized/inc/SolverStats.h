@@ -0,0 +1,55 @@
+/*
+ * SolverStats.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Counters filled in by the solvers during a solve. Solver::SolveWithin()
+ * resets them before calling Solve() and main prints them with the results.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+struct SolverStats {
+	// Search nodes expanded (calls into the recursive search)
+	long int nNodes;
+	// Branches pruned because too few agents are left to cover the remaining d_j
+	long int nPruneRequirements;
+	// Branches pruned because the bound is below the incumbent
+	long int nPruneBound;
+	// Branches pruned because no balanced matching covers the remaining d_j
+	long int nPruneMatching;
+	// Complete assignments that were scored
+	long int nLeaves;
+	// Complete assignments that did not meet every d_j
+	long int nInvalidLeaves;
+	// Poisson-Binomial evaluations (PMF terms, full PMFs and P_s tails)
+	long int nPMFCalls;
+	// Calls to the assignment problem solver and the time spent in it (s)
+	long int nHungarianCalls;
+	double fAssignmentTime;
+	// Moves scored from the move cache instead of a full benchmark
+	long int nCacheHits;
+	// Branches pruned because a searched state with the same agents left was as good on every task
+	long int nPruneDominance;
+	// Nodes where constraint propagation forced the agent's task, and nodes it showed can't be completed
+	long int nForced;
+	long int nPrunePropagation;
+	// Auction solves (--assignment=auction): bidding rounds over all of them, and the largest final epsilon and duality gap of any
+	long int nAuctionRounds;
+	double fAuctionEpsilon;
+	double fAuctionGap;
+
+	SolverStats() {Reset();}
+
+	// Sets all counters to 0
+	void Reset();
+	// Adds the counters of other (epsilon and gap take the larger), used to merge the counters of search threads
+	void Add(const SolverStats& other);
+	// Prints the counters on one line, in the order of PrintHeader()
+	void Print(FILE* stream) const;
+	// Prints the names of the counters on one line
+	static void PrintHeader(FILE* stream);
+};
@@ -0,0 +1,71 @@
+/*
+ * SparseLAP.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Shortest augmenting path solver for sparse linear assignment problems.
+ * Takes only the allowed (row, column, cost) edges; anything missing is forbidden, so
+ * there are no big-M INF entries to scan or to mix with costs in [0,1]. Each row is
+ * matched by a Dijkstra search over the reduced costs with a binary heap, touching
+ * only the edges it reaches, so the work scales with the number of edges.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+#include <queue>
+#include <limits>
+#include <algorithm>
+
+#include "defines.h"
+
+#define DEBUG_SPARSELAP	DEBUG || 0
+
+// Allowed pairing of a row and a column
+struct SparseEdge_t {
+	int row;
+	int col;
+	double cost;
+};
+
+class SparseLAP {
+public:
+	SparseLAP();
+	~SparseLAP();
+
+	/*
+	 * Minimizes the cost of assigning each of the nRows rows to a unique column, using only
+	 * the given edges (nRows <= nCols). Assignment[row] is set to the assigned column and
+	 * *cost to the total cost. Returns false if some row cannot be assigned.
+	 */
+	bool Solve(int nRows, int nCols, const std::vector<SparseEdge_t>& edges, std::vector<int>& Assignment, double* cost);
+	// Same as above on a dense matrix, entries >= INF are left out
+	bool Solve(std::vector<std::vector<double>>& DistMatrix, std::vector<int>& Assignment, double* cost);
+	// Same as above on an nRows x nCols row-major matrix
+	bool Solve(const double* CostMatrix, int nRows, int nCols, std::vector<int>& Assignment, double* cost);
+
+private:
+	// Matches free row s along a shortest augmenting path, updating the duals. Returns false if no free column is reachable
+	bool augment(int s);
+
+	// Edges in compressed row form
+	std::vector<int> m_vRowStart;
+	std::vector<int> m_vCol;
+	std::vector<double> m_vCost;
+	std::vector<SparseEdge_t> m_vEdges;
+	// Row and column duals, c_ij - u_i - v_j >= 0 with equality on matched pairs
+	std::vector<double> m_vU;
+	std::vector<double> m_vV;
+	// Matching, -1 if free
+	std::vector<int> m_vRowSol;
+	std::vector<int> m_vColSol;
+	// Dijkstra workspace, entries are only valid where m_vStamp matches the current search
+	std::vector<double> m_vDist;
+	std::vector<int> m_vPred;
+	std::vector<int> m_vStamp;
+	std::vector<bool> m_vSettled;
+	std::vector<int> m_vSettledList;
+	int m_nSearch;
+};
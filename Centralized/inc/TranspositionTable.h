@@ -0,0 +1,89 @@
+/*
+ * TranspositionTable.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Memory-bounded table of partial states already searched by a depth-first
+ * exact solver, used to prune states that can't lead anywhere better. Two partial states
+ * with the same multiset of agent classes left (see MASPInput::AgentClasses()) have the
+ * same completions, up to swapping interchangeable agents. Given such a completion, the
+ * P_s of task j only depends on the number of successes among the agents already on it,
+ * so if for every task P(X_j >= k) is at least as large in state A as in state B for
+ * k = 1..d_j (A's successes stochastically dominate B's), no completion of B beats the
+ * same completion of A. Once A's subtree has been searched, everything below it is at most
+ * the incumbent and B can be pruned. A state with the same classes on every task as a
+ * searched state is a transposition and is pruned without comparing.
+ *
+ * States are grouped by a Zobrist hash of the classes assigned so far (what is left to
+ * assign) and identified by a Zobrist hash of the class on each task, both sums of random
+ * keys so that they hash multisets. Each group hashes to a bucket of TT_BUCKET_SLOTS entries
+ * holding the two hashes and the survival values P(X_j >= k). A new state replaces an
+ * entry it dominates, otherwise the oldest one.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <random>
+
+#include "defines.h"
+#include "MASPInput.h"
+#include "SearchEngine.h"
+
+#define DEBUG_TT	DEBUG || 0
+// Entries per bucket
+#define TT_BUCKET_SLOTS	4
+
+class TranspositionTable {
+public:
+	TranspositionTable();
+	~TranspositionTable();
+
+	// Sizes the table for input to at most megabytes, agents with the same agentClass[i] are interchangeable
+	void Init(MASPInput* input, double megabytes, const std::vector<int>& agentClass);
+	/*
+	 * Is the current state of engine a transposition of a stored state, or dominated by
+	 * one with the same agents left? Leaves the hashes and survival values of the state in
+	 * the workspace for Store().
+	 */
+	bool Dominated(SearchEngine& engine);
+	/*
+	 * Stores the state last passed to Dominated(). The solver must search its whole subtree
+	 * before looking up any state that it could prune (always true in a serial depth-first
+	 * search, as those have other agents left than the states below it).
+	 */
+	void Store();
+	// Empties the table
+	void Clear();
+
+private:
+	// Does the entry at slot dominate the workspace state (or, with reverse, is it dominated by it)?
+	bool dominates(size_t slot, bool reverse);
+
+	MASPInput* m_pInput;
+	// Zobrist keys: per class, and per class and task
+	std::vector<uint64_t> m_vClassKey;
+	std::vector<std::vector<uint64_t>> m_vvTaskKey;
+	std::vector<int> m_vClass;
+	// Survival values per entry (sum of d_j), where the values of each task start, and the number of buckets
+	int m_nSurvival;
+	std::vector<int> m_vOffset;
+	size_t m_nBuckets;
+	// Per slot: group hash, state hash and survival values (left uninitialized, pages are only touched once used), whether it is used; per bucket the next slot to replace
+	std::unique_ptr<uint64_t[]> m_pGroup;
+	std::unique_ptr<uint64_t[]> m_pState;
+	std::unique_ptr<double[]> m_pSurvival;
+	std::vector<bool> m_vUsed;
+	std::vector<unsigned char> m_vNext;
+	// Workspace: the state last looked up and the PMF of the agents on one task, cut at d_j
+	uint64_t m_nGroup;
+	uint64_t m_nState;
+	std::vector<double> m_vWork;
+	std::vector<double> m_vPMF;
+};
@@ -0,0 +1,69 @@
+/*
+ * WorkStealingPool.h
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Thread pool for tree searches. Every thread owns a deque of tasks, works
+ * off the back of its own deque (depth-first) and, once that is empty, steals from the
+ * front of another thread's deque, where the shallowest and largest subtrees sit. Tasks
+ * may push more tasks while they run. Run() returns once every deque is empty and no
+ * task is running.
+ */
+
+#pragma once
+
+#include <stdio.h>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <thread>
+#include <mutex>
+#include <atomic>
+
+#include "defines.h"
+
+#define DEBUG_WSPOOL	DEBUG || 0
+
+class WorkStealingPool {
+public:
+	// A task gets the index of the thread that runs it
+	typedef std::function<void(int)> Task;
+
+	WorkStealingPool();
+	~WorkStealingPool();
+
+	// Empties the pool and sets up deques for nThreads threads
+	void Reset(int nThreads);
+	// Adds task to the back of thread t's deque, may be called from a running task
+	void Push(int t, Task task);
+	// Runs the tasks on the threads of the pool, the calling thread is thread 0
+	void Run();
+
+	int Threads() {return m_vDeques.size();}
+	// Number of threads currently looking for work
+	int Idle() {return m_nIdle.load(std::memory_order_relaxed);}
+	// Tasks run and tasks stolen during the last Run()
+	long int Executed() {return m_nExecuted;}
+	long int Steals() {return m_nSteals;}
+
+private:
+	struct Deque_t {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	// Takes a task from the back of thread t's own deque
+	bool pop(int t, Task& task);
+	// Takes a task from the front of some other thread's deque
+	bool steal(int t, Task& task);
+	void workerLoop(int t);
+
+	std::vector<std::unique_ptr<Deque_t>> m_vDeques;
+	// Tasks pushed but not finished yet
+	std::atomic<long int> m_nPending;
+	std::atomic<int> m_nIdle;
+	std::atomic<long int> m_nExecuted;
+	std::atomic<long int> m_nSteals;
+};
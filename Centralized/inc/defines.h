@@ -29,5 +29,6 @@ enum {
 	e_Algo_MASP_LOGMATCH = 9,
 	e_Algo_MASP_SWAP = 10,
 	e_Algo_MASP_BNM = 11,
-	e_Algo_MASP_BNB = 12
+	e_Algo_MASP_BNB = 12,
+	e_Algo_MASP_TYPEDP = 13
 };
@@ -0,0 +1,352 @@
+#include "Auction.h"
+
+Auction::Auction() {
+	m_nThreads = 1;
+	m_nIterations = 0;
+	m_fEpsilon = 0;
+	m_fGap = 0;
+	m_nGeneration = 0;
+	m_nPending = 0;
+	m_bQuit = false;
+	m_nRoundN = 0;
+	m_fRoundEps = 0;
+	m_nRoundSize = 0;
+}
+
+Auction::~Auction() {
+	stopPool();
+}
+
+// Sets the number of bidding threads: 1 bids Gauss-Seidel, more bid Jacobi in parallel
+void Auction::SetThreads(int nThreads) {
+	m_nThreads = std::max(1, nThreads);
+}
+
+/*
+ * Minimizes the cost of assigning each row of DistMatrix to a unique column.
+ * Assignment[row] is set to the assigned column, or -1 if the row could not be
+ * assigned (more rows than columns). Returns the cost of the assignment.
+ */
+double Auction::Solve(std::vector<std::vector<double>>& DistMatrix, std::vector<int>& Assignment) {
+	int nRows = DistMatrix.size();
+	int nCols = (nRows > 0) ? DistMatrix[0].size() : 0;
+
+	std::vector<double> flat((size_t)nRows*nCols);
+	for(int i = 0; i < nRows; i++) {
+		std::copy(DistMatrix[i].begin(), DistMatrix[i].end(), flat.begin() + (size_t)i*nCols);
+	}
+
+	return Solve(flat.data(), nRows, nCols, Assignment);
+}
+
+// Same as above for an nRows x nCols row-major matrix
+double Auction::Solve(const double* CostMatrix, int nRows, int nCols, std::vector<int>& Assignment) {
+	int n = std::max(nRows, nCols);
+	m_nIterations = 0;
+	m_fEpsilon = 0;
+	m_fGap = 0;
+
+	Assignment.assign(nRows, -1);
+	if(nRows == 0 || nCols == 0) {
+		return 0;
+	}
+
+	// Range of the allowed costs
+	double minCost = std::numeric_limits<double>::infinity();
+	double maxCost = -std::numeric_limits<double>::infinity();
+	for(size_t e = 0; e < (size_t)nRows*nCols; e++) {
+		if(CostMatrix[e] < INF) {
+			minCost = std::min(minCost, CostMatrix[e]);
+			maxCost = std::max(maxCost, CostMatrix[e]);
+		}
+	}
+	if(maxCost < minCost) {
+		minCost = maxCost = 0;
+	}
+	// Forbidden pairs cost more than any assignment that avoids them
+	double forbidden = maxCost + (maxCost - minCost + 1)*n;
+
+	// Square benefit matrix, padded with zero-cost dummy rows/columns
+	m_vBenefit.assign((size_t)n*n, 0.0);
+	for(int i = 0; i < nRows; i++) {
+		for(int j = 0; j < nCols; j++) {
+			double cost = CostMatrix[(size_t)i*nCols + j];
+			m_vBenefit[(size_t)i*n + j] = -((cost < INF) ? cost : forbidden);
+		}
+	}
+
+	solveSquare(n);
+
+	// Extract the assignment of the real rows to real columns
+	double cost = 0;
+	for(int i = 0; i < nRows; i++) {
+		int j = m_vRowSol[i];
+		if(j < nCols) {
+			Assignment[i] = j;
+			cost += CostMatrix[(size_t)i*nCols + j];
+		}
+	}
+
+	return cost;
+}
+
+// Runs the auction on the n x n row-major matrix in m_vBenefit, fills m_vRowSol
+void Auction::solveSquare(int n) {
+	double minB = *std::min_element(m_vBenefit.begin(), m_vBenefit.end());
+	double maxB = *std::max_element(m_vBenefit.begin(), m_vBenefit.end());
+	double range = maxB - minB;
+
+	m_vPrice.assign(n, 0.0);
+	m_vRowSol.assign(n, -1);
+	m_vColSol.assign(n, -1);
+	m_vRoundSeen.assign(n, -1);
+	m_vWinner.assign(n, -1);
+
+	if(range <= 0) {
+		// Every assignment costs the same
+		for(int i = 0; i < n; i++) {
+			m_vRowSol[i] = i;
+			m_vColSol[i] = i;
+		}
+		return;
+	}
+
+	// Below 1/n of this, the result is within range*AUCTION_EPS_FINAL of optimal
+	double epsFinal = range*AUCTION_EPS_FINAL/n;
+	double eps = std::max(range/AUCTION_EPS_FACTOR, epsFinal);
+	bool jacobi = m_nThreads > 1;
+	if(jacobi) {
+		startPool();
+	}
+
+	while(true) {
+		if(jacobi) {
+			jacobiPhase(n, eps);
+		}
+		else {
+			gaussSeidelPhase(n, eps);
+		}
+
+		if(DEBUG_AUCTION)
+			printf("Auction: phase eps = %g done, %ld rounds so far\n", eps, m_nIterations);
+
+		if(eps <= epsFinal) {
+			break;
+		}
+		eps = std::max(eps/AUCTION_EPS_FACTOR, epsFinal);
+	}
+
+	stopPool();
+	m_fEpsilon = eps;
+	m_fGap = dualityGap(n);
+}
+
+// One scaling phase, bidding one row at a time
+void Auction::gaussSeidelPhase(int n, double eps) {
+	// Start over with every row unassigned, prices carry over from the last phase
+	std::fill(m_vRowSol.begin(), m_vRowSol.end(), -1);
+	std::fill(m_vColSol.begin(), m_vColSol.end(), -1);
+	m_vUnassigned.clear();
+	for(int i = n - 1; i >= 0; i--) {
+		m_vUnassigned.push_back(i);
+	}
+
+	while(!m_vUnassigned.empty()) {
+		int i = m_vUnassigned.back();
+		m_vUnassigned.pop_back();
+
+		double bidPrice;
+		int j = bid(n, i, eps, &bidPrice);
+
+		// i takes j, its old owner goes back to bidding
+		int prev = m_vColSol[j];
+		if(prev >= 0) {
+			m_vRowSol[prev] = -1;
+			m_vUnassigned.push_back(prev);
+		}
+		m_vRowSol[i] = j;
+		m_vColSol[j] = i;
+		m_vPrice[j] = bidPrice;
+		m_nIterations++;
+	}
+}
+
+// One scaling phase, all unassigned rows bid in parallel
+void Auction::jacobiPhase(int n, double eps) {
+	// Start over with every row unassigned, prices carry over from the last phase
+	std::fill(m_vRowSol.begin(), m_vRowSol.end(), -1);
+	std::fill(m_vColSol.begin(), m_vColSol.end(), -1);
+	m_vUnassigned.clear();
+	for(int i = 0; i < n; i++) {
+		m_vUnassigned.push_back(i);
+	}
+
+	std::vector<int> stillUnassigned;
+	while(!m_vUnassigned.empty()) {
+		int size = m_vUnassigned.size();
+		m_vBidColumn.resize(size);
+		m_vBidPrice.resize(size);
+		runRound(n, eps);
+		m_nIterations++;
+
+		// Highest bid on each column wins
+		for(int k = 0; k < size; k++) {
+			int j = m_vBidColumn[k];
+			if(m_vRoundSeen[j] != m_nIterations || m_vBidPrice[k] > m_vBidPrice[m_vWinner[j]]) {
+				m_vRoundSeen[j] = m_nIterations;
+				m_vWinner[j] = k;
+			}
+		}
+
+		// Hand out the columns, losers and displaced owners bid again next round
+		stillUnassigned.clear();
+		for(int k = 0; k < size; k++) {
+			int i = m_vUnassigned[k];
+			int j = m_vBidColumn[k];
+			if(m_vWinner[j] == k) {
+				int prev = m_vColSol[j];
+				if(prev >= 0) {
+					m_vRowSol[prev] = -1;
+					stillUnassigned.push_back(prev);
+				}
+				m_vRowSol[i] = j;
+				m_vColSol[j] = i;
+				m_vPrice[j] = m_vBidPrice[k];
+			}
+			else {
+				stillUnassigned.push_back(i);
+			}
+		}
+		m_vUnassigned.swap(stillUnassigned);
+	}
+}
+
+// Finds row i's best column and its bid, returns the column
+int Auction::bid(int n, int i, double eps, double* bidPrice) {
+	const double* row = &m_vBenefit[(size_t)i*n];
+	double best = -std::numeric_limits<double>::infinity();
+	double second = -std::numeric_limits<double>::infinity();
+	int bestJ = 0;
+	for(int j = 0; j < n; j++) {
+		double value = row[j] - m_vPrice[j];
+		if(value > best) {
+			second = best;
+			best = value;
+			bestJ = j;
+		}
+		else if(value > second) {
+			second = value;
+		}
+	}
+	if(n == 1) {
+		second = best;
+	}
+
+	// Raise the price until i would be indifferent (up to eps) to its second choice
+	*bidPrice = m_vPrice[bestJ] + (best - second) + eps;
+	return bestJ;
+}
+
+// Computes bids for m_vUnassigned[first..last)
+void Auction::bidRange(int n, double eps, int first, int last) {
+	for(int k = first; k < last; k++) {
+		m_vBidColumn[k] = bid(n, m_vUnassigned[k], eps, &m_vBidPrice[k]);
+	}
+}
+
+// Dual bound minus primal benefit of the current assignment
+double Auction::dualityGap(int n) {
+	double dual = 0;
+	double primal = 0;
+	for(int j = 0; j < n; j++) {
+		dual += m_vPrice[j];
+	}
+	for(int i = 0; i < n; i++) {
+		const double* row = &m_vBenefit[(size_t)i*n];
+		double best = -std::numeric_limits<double>::infinity();
+		for(int j = 0; j < n; j++) {
+			best = std::max(best, row[j] - m_vPrice[j]);
+		}
+		dual += best;
+		primal += row[m_vRowSol[i]];
+	}
+
+	return dual - primal;
+}
+
+// Starts m_nThreads-1 workers, the calling thread does the first share of each round
+void Auction::startPool() {
+	stopPool();
+	m_bQuit = false;
+	m_nGeneration = 0;
+	for(int t = 1; t < m_nThreads; t++) {
+		m_vWorkers.push_back(std::thread(&Auction::workerLoop, this, t));
+	}
+}
+
+// Stops and joins the workers
+void Auction::stopPool() {
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bQuit = true;
+	}
+	m_cvStart.notify_all();
+	for(std::thread& worker : m_vWorkers) {
+		worker.join();
+	}
+	m_vWorkers.clear();
+}
+
+// Worker t waits for a round, bids for its share of m_vUnassigned and reports back
+void Auction::workerLoop(int t) {
+	long int seen = 0;
+	while(true) {
+		int n, size;
+		double eps;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_cvStart.wait(lock, [&]{return m_bQuit || m_nGeneration != seen;});
+			if(m_bQuit) {
+				return;
+			}
+			seen = m_nGeneration;
+			n = m_nRoundN;
+			eps = m_fRoundEps;
+			size = m_nRoundSize;
+		}
+
+		bidRange(n, eps, (long int)size*t/m_nThreads, (long int)size*(t + 1)/m_nThreads);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if(--m_nPending == 0) {
+				m_cvDone.notify_one();
+			}
+		}
+	}
+}
+
+// Computes bids for every unassigned row, split across the pool
+void Auction::runRound(int n, double eps) {
+	int size = m_vUnassigned.size();
+	if(m_vWorkers.empty() || size < m_nThreads) {
+		// Not worth waking the pool
+		bidRange(n, eps, 0, size);
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_nRoundN = n;
+		m_fRoundEps = eps;
+		m_nRoundSize = size;
+		m_nPending = m_vWorkers.size();
+		m_nGeneration++;
+	}
+	m_cvStart.notify_all();
+
+	bidRange(n, eps, 0, size/m_nThreads);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cvDone.wait(lock, [&]{return m_nPending == 0;});
+}
@@ -0,0 +1,50 @@
+#include "BalancedModel.h"
+
+BalancedModel::BalancedModel() {
+	m_nN = 0;
+	m_nRequired = 0;
+	m_nFloating = 0;
+}
+
+BalancedModel::~BalancedModel() {}
+
+// Builds the slot tables for input in the given layout
+void BalancedModel::Build(MASPInput* input, int layout) {
+	m_nN = input->getN();
+	m_nRequired = 0;
+	for(int j = 0; j < input->getM(); j++) {
+		m_nRequired += input->get_d_j(j);
+	}
+	m_nFloating = m_nN - m_nRequired;
+
+	m_vSlotTask.clear();
+	m_vSlotFloating.clear();
+	if(layout == e_Layout_Balanced) {
+		// Each task gets its required slots followed by its own floating slots
+		for(int j = 0; j < input->getM(); j++) {
+			m_vSlotTask.insert(m_vSlotTask.end(), input->get_d_j(j), j);
+			m_vSlotFloating.insert(m_vSlotFloating.end(), input->get_d_j(j), false);
+			if(m_nFloating > 0) {
+				m_vSlotTask.insert(m_vSlotTask.end(), m_nFloating, j);
+				m_vSlotFloating.insert(m_vSlotFloating.end(), m_nFloating, true);
+			}
+		}
+	}
+	else if(layout == e_Layout_Square) {
+		// One slot per agent, required slots first and the rest belong to no task
+		for(int j = 0; j < input->getM() && (int)m_vSlotTask.size() < m_nN; j++) {
+			int d_j = std::min(input->get_d_j(j), m_nN - (int)m_vSlotTask.size());
+			m_vSlotTask.insert(m_vSlotTask.end(), d_j, j);
+		}
+		m_vSlotFloating.assign(m_vSlotTask.size(), false);
+		m_vSlotTask.resize(m_nN, -1);
+		m_vSlotFloating.resize(m_nN, true);
+	}
+	else {
+		fprintf(stderr, "[BalancedModel::Build] : Unknown layout = %d\n", layout);
+		exit(1);
+	}
+
+	if(DEBUG_BALMODEL)
+		printf("BalancedModel: layout=%d, a_r=%d, a_f=%d, slots=%d\n", layout, m_nRequired, m_nFloating, Size());
+}
@@ -0,0 +1,216 @@
+#include "Checkpoint.h"
+
+Checkpoint::Checkpoint() {
+	nInputHash = 0;
+	nN = 0;
+	nM = 0;
+	bDone = false;
+	fIncumbent = 0;
+	m_nChecksum = 0;
+}
+
+Checkpoint::~Checkpoint() {}
+
+/*
+ * Writes the checkpoint to a temporary file next to path and renames it over path, so
+ * the last good checkpoint survives a crash mid-write. Returns false on I/O errors.
+ */
+bool Checkpoint::Write(const std::string& path) {
+	std::string temp = path + ".tmp";
+	FILE* file = fopen(temp.c_str(), "wb");
+	if(file == NULL) {
+		return false;
+	}
+
+	m_nChecksum = CHECKPOINT_FNV_BASIS;
+	int32_t version = CHECKPOINT_VERSION;
+	int32_t N = nN;
+	int32_t M = nM;
+	int32_t done = bDone;
+	int64_t counters[] = {stats.nNodes, stats.nPruneRequirements, stats.nPruneBound, stats.nPruneMatching,
+			stats.nLeaves, stats.nInvalidLeaves, stats.nPMFCalls, stats.nHungarianCalls, stats.nCacheHits,
+			stats.nPruneDominance, stats.nForced, stats.nPrunePropagation, stats.nAuctionRounds};
+
+	bool good = put(file, CHECKPOINT_MAGIC, strlen(CHECKPOINT_MAGIC))
+			&& put(file, &version, sizeof(version))
+			&& put(file, &nInputHash, sizeof(nInputHash))
+			&& put(file, &N, sizeof(N))
+			&& put(file, &M, sizeof(M))
+			&& putVector(file, vOptions)
+			&& putVector(file, vOrder)
+			&& put(file, &done, sizeof(done))
+			&& put(file, &fIncumbent, sizeof(fIncumbent))
+			&& putVector(file, vIncumbent)
+			&& put(file, counters, sizeof(counters))
+			&& put(file, &stats.fAssignmentTime, sizeof(stats.fAssignmentTime))
+			&& put(file, &stats.fAuctionEpsilon, sizeof(stats.fAuctionEpsilon))
+			&& put(file, &stats.fAuctionGap, sizeof(stats.fAuctionGap))
+			&& putVector(file, vPath)
+			&& putVector(file, vNext);
+	// Checksum of everything above
+	uint64_t checksum = m_nChecksum;
+	good = good && put(file, &checksum, sizeof(checksum));
+
+	good = (fclose(file) == 0) && good;
+	if(!good || rename(temp.c_str(), path.c_str()) != 0) {
+		remove(temp.c_str());
+		return false;
+	}
+
+	if(DEBUG_CHECKPOINT)
+		printf("Checkpoint written to %s: depth %zu, Z = %f, %ld nodes\n", path.c_str(), vPath.size(), fIncumbent, stats.nNodes);
+
+	return true;
+}
+
+/*
+ * Reads path into this object, returns false if it can't be read, isn't a checkpoint of
+ * this version, fails its checksum or has vectors that don't fit its N
+ */
+bool Checkpoint::Read(const std::string& path) {
+	FILE* file = fopen(path.c_str(), "rb");
+	if(file == NULL) {
+		return false;
+	}
+
+	char magic[sizeof(CHECKPOINT_MAGIC)] = {0};
+	int32_t version = 0;
+	int32_t N = 0;
+	int32_t M = 0;
+	int32_t done = 0;
+	int64_t counters[13];
+	uint64_t checksum = 0;
+	m_nChecksum = CHECKPOINT_FNV_BASIS;
+
+	// Vector lengths are checked against N before anything is allocated
+	bool good = get(file, magic, strlen(CHECKPOINT_MAGIC))
+			&& strcmp(magic, CHECKPOINT_MAGIC) == 0
+			&& get(file, &version, sizeof(version))
+			&& version == CHECKPOINT_VERSION
+			&& get(file, &nInputHash, sizeof(nInputHash))
+			&& get(file, &N, sizeof(N))
+			&& get(file, &M, sizeof(M))
+			&& N >= 0 && N <= CHECKPOINT_MAX_DIM && M >= 0 && M <= CHECKPOINT_MAX_DIM
+			&& getVector(file, vOptions, CHECKPOINT_MAX_OPTIONS)
+			&& getVector(file, vOrder, N)
+			&& get(file, &done, sizeof(done))
+			&& get(file, &fIncumbent, sizeof(fIncumbent))
+			&& getVector(file, vIncumbent, N)
+			&& get(file, counters, sizeof(counters))
+			&& get(file, &stats.fAssignmentTime, sizeof(stats.fAssignmentTime))
+			&& get(file, &stats.fAuctionEpsilon, sizeof(stats.fAuctionEpsilon))
+			&& get(file, &stats.fAuctionGap, sizeof(stats.fAuctionGap))
+			&& getVector(file, vPath, N)
+			&& getVector(file, vNext, vPath.size());
+	// The checksum covers everything above, and has to be the last thing in the file
+	uint64_t expected = m_nChecksum;
+	good = good && get(file, &checksum, sizeof(checksum)) && checksum == expected && fgetc(file) == EOF;
+	fclose(file);
+
+	if(!good || (int)vOrder.size() != N || (int)vIncumbent.size() != N || vNext.size() != vPath.size()) {
+		return false;
+	}
+
+	nN = N;
+	nM = M;
+	bDone = done != 0;
+	stats.nNodes = counters[0];
+	stats.nPruneRequirements = counters[1];
+	stats.nPruneBound = counters[2];
+	stats.nPruneMatching = counters[3];
+	stats.nLeaves = counters[4];
+	stats.nInvalidLeaves = counters[5];
+	stats.nPMFCalls = counters[6];
+	stats.nHungarianCalls = counters[7];
+	stats.nCacheHits = counters[8];
+	stats.nPruneDominance = counters[9];
+	stats.nForced = counters[10];
+	stats.nPrunePropagation = counters[11];
+	stats.nAuctionRounds = counters[12];
+
+	if(DEBUG_CHECKPOINT)
+		printf("Checkpoint read from %s: depth %zu, Z = %f, %ld nodes\n", path.c_str(), vPath.size(), fIncumbent, stats.nNodes);
+
+	return true;
+}
+
+// Hash of everything in input the search depends on (N, M, d_j, p_ij and who can do what)
+uint64_t Checkpoint::InputHash(MASPInput* input) {
+	// FNV-1a over the raw bytes
+	uint64_t hash = CHECKPOINT_FNV_BASIS;
+
+	int N = input->getN();
+	int M = input->getM();
+	mix(&hash, &N, sizeof(N));
+	mix(&hash, &M, sizeof(M));
+	for(int j = 0; j < M; j++) {
+		int d_j = input->get_d_j(j);
+		mix(&hash, &d_j, sizeof(d_j));
+	}
+	for(int i = 0; i < N; i++) {
+		for(int j = 0; j < M; j++) {
+			double p_ij = input->get_p_ij(i, j);
+			char canDo = input->iCanDoj(i, j);
+			mix(&hash, &p_ij, sizeof(p_ij));
+			mix(&hash, &canDo, sizeof(canDo));
+		}
+	}
+
+	return hash;
+}
+
+// Raw write of bytes, false on I/O errors
+bool Checkpoint::put(FILE* file, const void* data, size_t bytes) {
+	mix(&m_nChecksum, data, bytes);
+	return fwrite(data, 1, bytes, file) == bytes;
+}
+
+// Raw read of bytes, false on I/O errors or a short file
+bool Checkpoint::get(FILE* file, void* data, size_t bytes) {
+	if(fread(data, 1, bytes, file) != bytes) {
+		return false;
+	}
+	mix(&m_nChecksum, data, bytes);
+	return true;
+}
+
+// Writes the length of v and its values as 32-bit ints
+bool Checkpoint::putVector(FILE* file, const std::vector<int>& v) {
+	int32_t size = v.size();
+	if(!put(file, &size, sizeof(size))) {
+		return false;
+	}
+	for(int x : v) {
+		int32_t value = x;
+		if(!put(file, &value, sizeof(value))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Reads a vector written by putVector(), false if it would be longer than maxSize
+bool Checkpoint::getVector(FILE* file, std::vector<int>& v, int maxSize) {
+	int32_t size = 0;
+	if(!get(file, &size, sizeof(size)) || size < 0 || size > maxSize) {
+		return false;
+	}
+	v.assign(size, 0);
+	for(int32_t k = 0; k < size; k++) {
+		int32_t value = 0;
+		if(!get(file, &value, sizeof(value))) {
+			return false;
+		}
+		v.at(k) = value;
+	}
+	return true;
+}
+
+// Adds bytes to the FNV-1a hash
+void Checkpoint::mix(uint64_t* hash, const void* data, size_t bytes) {
+	const unsigned char* p = (const unsigned char*)data;
+	for(size_t b = 0; b < bytes; b++) {
+		*hash ^= p[b];
+		*hash *= 1099511628211ULL;
+	}
+}
@@ -12,10 +12,61 @@
 #include <stdlib.h>
 #include <cfloat> // for DBL_MAX
 #include <cmath>  // for fabs()
+#include <algorithm> // for fill()
 #include "Hungarian.h"
 
 
-HungarianAlgorithm::HungarianAlgorithm(){}
+HungarianWorkspace::HungarianWorkspace()
+{
+	distMatrix = NULL;
+	assignment = NULL;
+	coveredColumns = coveredRows = starMatrix = newStarMatrix = primeMatrix = NULL;
+	nElementCap = nRowCap = nColumnCap = 0;
+}
+
+HungarianWorkspace::~HungarianWorkspace()
+{
+	free(distMatrix);
+	free(assignment);
+	free(coveredColumns);
+	free(coveredRows);
+	free(starMatrix);
+	free(newStarMatrix);
+	free(primeMatrix);
+}
+
+//********************************************************//
+// Grows the buffers to fit an nOfRows x nOfColumns problem (never shrinks)
+//********************************************************//
+void HungarianWorkspace::Reserve(int nOfRows, int nOfColumns)
+{
+	size_t nOfElements = (size_t)nOfRows * nOfColumns;
+	if (nOfElements > nElementCap)
+	{
+		nElementCap = nOfElements;
+		distMatrix = (double *)realloc(distMatrix, nElementCap * sizeof(double));
+		starMatrix = (bool *)realloc(starMatrix, nElementCap * sizeof(bool));
+		newStarMatrix = (bool *)realloc(newStarMatrix, nElementCap * sizeof(bool));
+		primeMatrix = (bool *)realloc(primeMatrix, nElementCap * sizeof(bool));
+	}
+	if ((size_t)nOfRows > nRowCap)
+	{
+		nRowCap = nOfRows;
+		assignment = (int *)realloc(assignment, nRowCap * sizeof(int));
+		coveredRows = (bool *)realloc(coveredRows, nRowCap * sizeof(bool));
+	}
+	if ((size_t)nOfColumns > nColumnCap)
+	{
+		nColumnCap = nOfColumns;
+		coveredColumns = (bool *)realloc(coveredColumns, nColumnCap * sizeof(bool));
+	}
+}
+
+
+HungarianAlgorithm::HungarianAlgorithm(){
+	m_nMethod = e_Assign_Munkres;
+	m_nThreads = 1;
+}
 HungarianAlgorithm::~HungarianAlgorithm(){}
 
 
@@ -24,6 +75,21 @@ HungarianAlgorithm::~HungarianAlgorithm(){}
 //********************************************************//
 double HungarianAlgorithm::Solve(vector <vector<double> >& DistMatrix, vector<int>& Assignment)
 {
+	if (m_nMethod == e_Assign_LAPJV)
+		return m_workspace.lapjv.Solve(DistMatrix, Assignment);
+	if (m_nMethod == e_Assign_Auction)
+	{
+		m_workspace.auction.SetThreads(m_nThreads);
+		return m_workspace.auction.Solve(DistMatrix, Assignment);
+	}
+	if (m_nMethod == e_Assign_Sparse)
+	{
+		double sparseCost;
+		if (m_workspace.sparse.Solve(DistMatrix, Assignment, &sparseCost))
+			return sparseCost;
+		// Some row needs an INF entry, let Munkres pick one like before
+	}
+
 	unsigned int nRows = DistMatrix.size();
 	unsigned int nCols = DistMatrix[0].size();
 
@@ -40,7 +106,8 @@ double HungarianAlgorithm::Solve(vector <vector<double> >& DistMatrix, vector<in
 			distMatrixIn[i + nRows * j] = DistMatrix[i][j];
 	
 	// call solving function
-	assignmentoptimal(assignment, &cost, distMatrixIn, nRows, nCols);
+	m_workspace.Reserve(nRows, nCols);
+	assignmentoptimal(assignment, &cost, distMatrixIn, nRows, nCols, m_workspace);
 
 	Assignment.clear();
 	for (unsigned int r = 0; r < nRows; r++)
@@ -52,10 +119,46 @@ double HungarianAlgorithm::Solve(vector <vector<double> >& DistMatrix, vector<in
 }
 
 
+//********************************************************//
+// Solves the nRows x nCols row-major CostMatrix using the buffers in Workspace.
+// A row-major matrix has the column-major layout of its transpose, so Munkres runs
+// on the transposed problem directly instead of copying the matrix into place.
+//********************************************************//
+double HungarianAlgorithm::Solve(const double* CostMatrix, int nRows, int nCols, vector<int>& Assignment, HungarianWorkspace& Workspace)
+{
+	if (m_nMethod == e_Assign_LAPJV)
+		return Workspace.lapjv.Solve(CostMatrix, nRows, nCols, Assignment);
+	if (m_nMethod == e_Assign_Auction)
+	{
+		Workspace.auction.SetThreads(m_nThreads);
+		return Workspace.auction.Solve(CostMatrix, nRows, nCols, Assignment);
+	}
+	if (m_nMethod == e_Assign_Sparse)
+	{
+		double sparseCost;
+		if (Workspace.sparse.Solve(CostMatrix, nRows, nCols, Assignment, &sparseCost))
+			return sparseCost;
+		// Some row needs an INF entry, let Munkres pick one like before
+	}
+
+	double cost = 0.0;
+	Workspace.Reserve(nCols, nRows);
+	assignmentoptimal(Workspace.assignment, &cost, CostMatrix, nCols, nRows, Workspace);
+
+	// Invert the column -> row assignment of the transposed problem
+	Assignment.assign(nRows, -1);
+	for (int col = 0; col < nCols; col++)
+		if (Workspace.assignment[col] >= 0)
+			Assignment[Workspace.assignment[col]] = col;
+
+	return cost;
+}
+
+
 //********************************************************//
 // Solve optimal solution for assignment problem using Munkres algorithm, also known as Hungarian Algorithm.
 //********************************************************//
-void HungarianAlgorithm::assignmentoptimal(int *assignment, double *cost, double *distMatrixIn, int nOfRows, int nOfColumns)
+void HungarianAlgorithm::assignmentoptimal(int *assignment, double *cost, const double *distMatrixIn, int nOfRows, int nOfColumns, HungarianWorkspace& workspace)
 {
 	double *distMatrix, *distMatrixTemp, *distMatrixEnd, *columnEnd, value, minValue;
 	bool *coveredColumns, *coveredRows, *starMatrix, *newStarMatrix, *primeMatrix;
@@ -69,7 +172,7 @@ void HungarianAlgorithm::assignmentoptimal(int *assignment, double *cost, double
 	/* generate working copy of distance Matrix */
 	/* check if all matrix elements are positive */
 	nOfElements = nOfRows * nOfColumns;
-	distMatrix = (double *)malloc(nOfElements * sizeof(double));
+	distMatrix = workspace.distMatrix;
 	distMatrixEnd = distMatrix + nOfElements;
 
 	for (row = 0; row<nOfElements; row++)
@@ -81,12 +184,17 @@ void HungarianAlgorithm::assignmentoptimal(int *assignment, double *cost, double
 	}
 
 
-	/* memory allocation */
-	coveredColumns = (bool *)calloc(nOfColumns, sizeof(bool));
-	coveredRows = (bool *)calloc(nOfRows, sizeof(bool));
-	starMatrix = (bool *)calloc(nOfElements, sizeof(bool));
-	primeMatrix = (bool *)calloc(nOfElements, sizeof(bool));
-	newStarMatrix = (bool *)calloc(nOfElements, sizeof(bool)); /* used in step4 */
+	/* take the buffers from the workspace (see Reserve()) and clear them */
+	coveredColumns = workspace.coveredColumns;
+	coveredRows = workspace.coveredRows;
+	starMatrix = workspace.starMatrix;
+	primeMatrix = workspace.primeMatrix;
+	newStarMatrix = workspace.newStarMatrix; /* used in step4 */
+	fill(coveredColumns, coveredColumns + nOfColumns, false);
+	fill(coveredRows, coveredRows + nOfRows, false);
+	fill(starMatrix, starMatrix + nOfElements, false);
+	fill(primeMatrix, primeMatrix + nOfElements, false);
+	fill(newStarMatrix, newStarMatrix + nOfElements, false);
 
 	/* preliminary steps */
 	if (nOfRows <= nOfColumns)
@@ -173,14 +281,6 @@ void HungarianAlgorithm::assignmentoptimal(int *assignment, double *cost, double
 	/* compute cost and remove invalid assignments */
 	computeassignmentcost(assignment, cost, distMatrixIn, nOfRows);
 
-	/* free allocated memory */
-	free(distMatrix);
-	free(coveredColumns);
-	free(coveredRows);
-	free(starMatrix);
-	free(primeMatrix);
-	free(newStarMatrix);
-
 	return;
 }
 
@@ -203,7 +303,7 @@ void HungarianAlgorithm::buildassignmentvector(int *assignment, bool *starMatrix
 }
 
 /********************************************************/
-void HungarianAlgorithm::computeassignmentcost(int *assignment, double *cost, double *distMatrix, int nOfRows)
+void HungarianAlgorithm::computeassignmentcost(int *assignment, double *cost, const double *distMatrix, int nOfRows)
 {
 	int row, col;
 
@@ -0,0 +1,235 @@
+#include "IncrementalLAP.h"
+
+IncrementalLAP::IncrementalLAP() {}
+
+IncrementalLAP::~IncrementalLAP() {}
+
+// Solves the n x n problem CostMatrix from scratch and keeps it for the updates below. Returns the cost
+double IncrementalLAP::Solve(const std::vector<std::vector<double>>& CostMatrix) {
+	int n = CostMatrix.size();
+	for(const std::vector<double>& row : CostMatrix) {
+		if((int)row.size() != n) {
+			fprintf(stderr, "[ERROR][IncrementalLAP::Solve] : Cost matrix is not square\n");
+			exit(1);
+		}
+	}
+
+	m_vvCost = CostMatrix;
+	m_vU.assign(n, 0.0);
+	m_vV.assign(n, 0.0);
+	m_vRowSol.assign(n, -1);
+	m_vColSol.assign(n, -1);
+
+	// Start with column duals at each column's minimum, every reduced cost is then >= 0
+	for(int j = 0; j < n; j++) {
+		double min = std::numeric_limits<double>::infinity();
+		for(int i = 0; i < n; i++) {
+			min = std::min(min, m_vvCost[i][j]);
+		}
+		m_vV[j] = min;
+	}
+
+	for(int i = 0; i < n; i++) {
+		augment(i);
+	}
+
+	return Cost();
+}
+
+// Replaces the costs of row i, returns the new optimal cost
+double IncrementalLAP::UpdateRow(int i, const std::vector<double>& row) {
+	checkIndex(i, "UpdateRow");
+	int n = Size();
+	m_vvCost[i] = row;
+
+	// Free row i and lower its dual until all of its reduced costs are >= 0
+	m_vColSol[m_vRowSol[i]] = -1;
+	m_vRowSol[i] = -1;
+	double min = std::numeric_limits<double>::infinity();
+	for(int j = 0; j < n; j++) {
+		min = std::min(min, m_vvCost[i][j] - m_vV[j]);
+	}
+	m_vU[i] = min;
+
+	augment(i);
+
+	return Cost();
+}
+
+// Replaces the costs of column j, returns the new optimal cost
+double IncrementalLAP::UpdateColumn(int j, const std::vector<double>& col) {
+	checkIndex(j, "UpdateColumn");
+	int n = Size();
+	for(int i = 0; i < n; i++) {
+		m_vvCost[i][j] = col.at(i);
+	}
+
+	// Free the row on j and lower j's dual until all of its reduced costs are >= 0
+	int i0 = m_vColSol[j];
+	m_vRowSol[i0] = -1;
+	m_vColSol[j] = -1;
+	double min = std::numeric_limits<double>::infinity();
+	for(int i = 0; i < n; i++) {
+		min = std::min(min, m_vvCost[i][j] - m_vU[i]);
+	}
+	m_vV[j] = min;
+
+	augment(i0);
+
+	return Cost();
+}
+
+/*
+ * Adds a row and a column, n -> n+1. row holds the n+1 costs of the new row (new column
+ * last), col holds the costs of the n existing rows in the new column. Returns the new
+ * optimal cost.
+ */
+double IncrementalLAP::Add(const std::vector<double>& row, const std::vector<double>& col) {
+	int n = Size();
+
+	// New column, dual set so that none of its reduced costs are negative
+	double min = (n > 0) ? std::numeric_limits<double>::infinity() : 0;
+	for(int i = 0; i < n; i++) {
+		m_vvCost[i].push_back(col.at(i));
+		min = std::min(min, col.at(i) - m_vU[i]);
+	}
+	m_vV.push_back(min);
+	m_vColSol.push_back(-1);
+
+	// New row, same idea
+	m_vvCost.push_back(row);
+	m_vvCost.back().resize(n + 1);
+	min = std::numeric_limits<double>::infinity();
+	for(int j = 0; j <= n; j++) {
+		min = std::min(min, m_vvCost[n][j] - m_vV[j]);
+	}
+	m_vU.push_back(min);
+	m_vRowSol.push_back(-1);
+
+	// The only free row and column, one path matches them
+	augment(n);
+
+	return Cost();
+}
+
+// Removes row i and column j, n -> n-1. Later rows/columns shift down by one. Returns the new optimal cost
+double IncrementalLAP::RemoveRowColumn(int i, int j) {
+	checkIndex(i, "RemoveRowColumn");
+	checkIndex(j, "RemoveRowColumn");
+
+	// Row that loses its column and column that loses its row
+	int i1 = m_vColSol[j];
+	int j1 = m_vRowSol[i];
+
+	m_vvCost.erase(m_vvCost.begin() + i);
+	for(std::vector<double>& row : m_vvCost) {
+		row.erase(row.begin() + j);
+	}
+	m_vU.erase(m_vU.begin() + i);
+	m_vV.erase(m_vV.begin() + j);
+	m_vRowSol.erase(m_vRowSol.begin() + i);
+	m_vColSol.erase(m_vColSol.begin() + j);
+
+	// Shift indices past the removed row/column
+	for(int& col : m_vRowSol) {
+		if(col > j) {
+			col--;
+		}
+	}
+	for(int& row : m_vColSol) {
+		if(row > i) {
+			row--;
+		}
+	}
+
+	// If i was matched to j, what remains is still optimal
+	if(i1 != i) {
+		if(i1 > i) {
+			i1--;
+		}
+		if(j1 > j) {
+			j1--;
+		}
+		m_vRowSol[i1] = -1;
+		m_vColSol[j1] = -1;
+		augment(i1);
+	}
+
+	return Cost();
+}
+
+// Cost of the current assignment
+double IncrementalLAP::Cost() {
+	double cost = 0;
+	for(int i = 0; i < Size(); i++) {
+		cost += m_vvCost[i][m_vRowSol[i]];
+	}
+
+	return cost;
+}
+
+// Matches free row i0 along a shortest augmenting path, updating the duals. O(n^2)
+void IncrementalLAP::augment(int i0) {
+	int n = Size();
+	m_vMinV.assign(n, std::numeric_limits<double>::infinity());
+	m_vWay.assign(n, -1);
+	m_vUsed.assign(n, false);
+
+	// Grow a Dijkstra tree of columns from i0 until it reaches a free column
+	int j0 = -1;
+	do {
+		int i = (j0 < 0) ? i0 : m_vColSol[j0];
+		if(j0 >= 0) {
+			m_vUsed[j0] = true;
+		}
+
+		double delta = std::numeric_limits<double>::infinity();
+		int j1 = -1;
+		for(int j = 0; j < n; j++) {
+			if(!m_vUsed[j]) {
+				double reduced = m_vvCost[i][j] - m_vU[i] - m_vV[j];
+				if(reduced < m_vMinV[j]) {
+					m_vMinV[j] = reduced;
+					m_vWay[j] = j0;
+				}
+				if(m_vMinV[j] < delta) {
+					delta = m_vMinV[j];
+					j1 = j;
+				}
+			}
+		}
+
+		// Shift the duals so that the closest column becomes tight
+		m_vU[i0] += delta;
+		for(int j = 0; j < n; j++) {
+			if(m_vUsed[j]) {
+				m_vU[m_vColSol[j]] += delta;
+				m_vV[j] -= delta;
+			}
+			else {
+				m_vMinV[j] -= delta;
+			}
+		}
+		j0 = j1;
+	} while(m_vColSol[j0] >= 0);
+
+	// Flip the matching along the path
+	while(j0 >= 0) {
+		int prev = m_vWay[j0];
+		int row = (prev < 0) ? i0 : m_vColSol[prev];
+		m_vColSol[j0] = row;
+		m_vRowSol[row] = j0;
+		j0 = prev;
+	}
+
+	if(DEBUG_INCLAP)
+		printf("IncrementalLAP: matched row %d, cost = %f\n", i0, Cost());
+}
+
+// Hard fails if i is not a valid row/column index
+void IncrementalLAP::checkIndex(int i, const char* func) {
+	if(i < 0 || i >= Size()) {
+		fprintf(stderr, "[ERROR][IncrementalLAP::%s] : Index %d out of range, n = %d\n", func, i, Size());
+		exit(1);
+	}
+}
@@ -0,0 +1,306 @@
+#include "LAPJV.h"
+
+LAPJV::LAPJV() {}
+
+LAPJV::~LAPJV() {}
+
+/*
+ * Minimizes the cost of assigning each row of DistMatrix to a unique column.
+ * Assignment[row] is set to the assigned column, or -1 if the row could not be
+ * assigned (more rows than columns). Returns the cost of the assignment.
+ */
+double LAPJV::Solve(std::vector<std::vector<double>>& DistMatrix, std::vector<int>& Assignment) {
+	int nRows = DistMatrix.size();
+	int nCols = (nRows > 0) ? DistMatrix[0].size() : 0;
+	int n = std::max(nRows, nCols);
+
+	Assignment.assign(nRows, -1);
+	if(nRows == 0 || nCols == 0) {
+		return 0;
+	}
+
+	// Copy into a square row-major matrix, padding with zero-cost dummy rows/columns
+	m_vCost.assign((size_t)n*n, 0.0);
+	for(int i = 0; i < nRows; i++) {
+		double* row = &m_vCost[(size_t)i*n];
+		for(int j = 0; j < nCols; j++) {
+			row[j] = DistMatrix[i][j];
+		}
+	}
+
+	solveSquare(m_vCost.data(), n);
+
+	// Extract the assignment of the real rows to real columns
+	double cost = 0;
+	for(int i = 0; i < nRows; i++) {
+		int j = m_vRowSol[i];
+		if(j < nCols) {
+			Assignment[i] = j;
+			cost += DistMatrix[i][j];
+		}
+	}
+
+	if(DEBUG_LAPJV)
+		printf("LAPJV: %d x %d, cost = %f\n", nRows, nCols, cost);
+
+	return cost;
+}
+
+// Same as above for an nRows x nCols row-major matrix, square matrices are solved in place
+double LAPJV::Solve(const double* CostMatrix, int nRows, int nCols, std::vector<int>& Assignment) {
+	int n = std::max(nRows, nCols);
+
+	Assignment.assign(nRows, -1);
+	if(nRows == 0 || nCols == 0) {
+		return 0;
+	}
+
+	if(nRows == nCols) {
+		solveSquare(CostMatrix, n);
+	}
+	else {
+		// Pad to square with zero-cost dummy rows/columns
+		m_vCost.assign((size_t)n*n, 0.0);
+		for(int i = 0; i < nRows; i++) {
+			std::copy(CostMatrix + (size_t)i*nCols, CostMatrix + (size_t)(i + 1)*nCols, &m_vCost[(size_t)i*n]);
+		}
+		solveSquare(m_vCost.data(), n);
+	}
+
+	double cost = 0;
+	for(int i = 0; i < nRows; i++) {
+		int j = m_vRowSol[i];
+		if(j < nCols) {
+			Assignment[i] = j;
+			cost += CostMatrix[(size_t)i*nCols + j];
+		}
+	}
+
+	if(DEBUG_LAPJV)
+		printf("LAPJV: %d x %d, cost = %f\n", nRows, nCols, cost);
+
+	return cost;
+}
+
+// Runs the solver on the n x n row-major matrix cost, fills m_vRowSol/m_vColSol
+void LAPJV::solveSquare(const double* cost, int n) {
+	const double BIG = std::numeric_limits<double>::max();
+
+	m_vRowSol.assign(n, -1);
+	m_vColSol.assign(n, -1);
+	m_vV.assign(n, 0.0);
+	m_vD.assign(n, 0.0);
+	m_vFree.assign(n, 0);
+	m_vColList.assign(n, 0);
+	m_vMatches.assign(n, 0);
+	m_vPred.assign(n, 0);
+	int* rowsol = m_vRowSol.data();
+	int* colsol = m_vColSol.data();
+	double* v = m_vV.data();
+	double* d = m_vD.data();
+	int* freeRows = m_vFree.data();
+	int* collist = m_vColList.data();
+	int* matches = m_vMatches.data();
+	int* pred = m_vPred.data();
+
+	/// Column reduction, scanning columns in reverse so low columns win ties
+	for(int j = n - 1; j >= 0; j--) {
+		double min = cost[j];
+		int imin = 0;
+		for(int i = 1; i < n; i++) {
+			if(cost[(size_t)i*n + j] < min) {
+				min = cost[(size_t)i*n + j];
+				imin = i;
+			}
+		}
+		v[j] = min;
+
+		if(++matches[imin] == 1) {
+			// First column claimed by this row
+			rowsol[imin] = j;
+			colsol[j] = imin;
+		}
+		else if(v[j] < v[rowsol[imin]]) {
+			// Row prefers this column over the one it already has
+			int j1 = rowsol[imin];
+			rowsol[imin] = j;
+			colsol[j] = imin;
+			colsol[j1] = -1;
+		}
+		else {
+			colsol[j] = -1;
+		}
+	}
+
+	/// Reduction transfer from assigned rows to their columns
+	int numFree = 0;
+	for(int i = 0; i < n; i++) {
+		if(matches[i] == 0) {
+			freeRows[numFree++] = i;
+		}
+		else if(matches[i] == 1) {
+			int j1 = rowsol[i];
+			double min = BIG;
+			for(int j = 0; j < n; j++) {
+				if(j != j1 && cost[(size_t)i*n + j] - v[j] < min) {
+					min = cost[(size_t)i*n + j] - v[j];
+				}
+			}
+			if(min < BIG) {
+				v[j1] -= min;
+			}
+		}
+	}
+
+	/*
+	 * Augmenting row reduction, two passes over the free rows. With real-valued costs two
+	 * rows can trade a column back and forth while lowering its price by tiny amounts, so
+	 * the number of immediate retries is capped and rows past the cap wait for the
+	 * augmentation phase instead.
+	 */
+	for(int loop = 0; loop < 2; loop++) {
+		int k = 0;
+		int prvNumFree = numFree;
+		long int rrCount = 0;
+		numFree = 0;
+		while(k < prvNumFree) {
+			int i = freeRows[k++];
+			bool retry = (++rrCount < (long int)k*n);
+
+			// Find the smallest and second smallest reduced cost in row i
+			double umin = cost[(size_t)i*n] - v[0];
+			double usubmin = BIG;
+			int j1 = 0;
+			int j2 = -1;
+			for(int j = 1; j < n; j++) {
+				double h = cost[(size_t)i*n + j] - v[j];
+				if(h < usubmin) {
+					if(h >= umin) {
+						usubmin = h;
+						j2 = j;
+					}
+					else {
+						usubmin = umin;
+						umin = h;
+						j2 = j1;
+						j1 = j;
+					}
+				}
+			}
+
+			int i0 = colsol[j1];
+			bool lowered = retry && (v[j1] - (usubmin - umin) < v[j1]);
+			if(lowered) {
+				// Lower the price of j1 so i keeps it against its current owner
+				v[j1] -= (usubmin - umin);
+			}
+			else if(retry && i0 > -1 && j2 >= 0) {
+				// Tie, take the second best column instead
+				j1 = j2;
+				i0 = colsol[j2];
+			}
+
+			rowsol[i] = j1;
+			colsol[j1] = i;
+			if(i0 > -1) {
+				if(lowered) {
+					// Try the displaced row again right away
+					freeRows[--k] = i0;
+				}
+				else {
+					freeRows[numFree++] = i0;
+				}
+				rowsol[i0] = -1;
+			}
+		}
+	}
+
+	/// Augment each remaining free row along a shortest path
+	for(int f = 0; f < numFree; f++) {
+		int freeRow = freeRows[f];
+
+		// Dijkstra-like search over the reduced costs
+		for(int j = 0; j < n; j++) {
+			d[j] = cost[(size_t)freeRow*n + j] - v[j];
+			pred[j] = freeRow;
+			collist[j] = j;
+		}
+
+		int low = 0;
+		int up = 0;
+		int last = 0;
+		int endOfPath = -1;
+		double min = 0;
+		bool unassignedFound = false;
+		do {
+			if(up == low) {
+				// Collect the columns at the new minimum distance
+				last = low - 1;
+				min = d[collist[up++]];
+				for(int k = up; k < n; k++) {
+					int j = collist[k];
+					double h = d[j];
+					if(h <= min) {
+						if(h < min) {
+							up = low;
+							min = h;
+						}
+						collist[k] = collist[up];
+						collist[up++] = j;
+					}
+				}
+
+				// Is any of them unassigned?
+				for(int k = low; k < up; k++) {
+					if(colsol[collist[k]] < 0) {
+						endOfPath = collist[k];
+						unassignedFound = true;
+						break;
+					}
+				}
+			}
+
+			if(!unassignedFound) {
+				// Scan a column at the minimum distance
+				int j1 = collist[low++];
+				int i = colsol[j1];
+				double h = cost[(size_t)i*n + j1] - v[j1] - min;
+				for(int k = up; k < n; k++) {
+					int j = collist[k];
+					double v2 = cost[(size_t)i*n + j] - v[j] - h;
+					if(v2 < d[j]) {
+						pred[j] = i;
+						if(v2 <= min) {
+							if(colsol[j] < 0) {
+								endOfPath = j;
+								unassignedFound = true;
+								break;
+							}
+							else {
+								collist[k] = collist[up];
+								collist[up++] = j;
+							}
+						}
+						d[j] = v2;
+					}
+				}
+			}
+		} while(!unassignedFound);
+
+		// Update the prices of the columns that were fully scanned
+		for(int k = 0; k <= last; k++) {
+			int j1 = collist[k];
+			v[j1] += d[j1] - min;
+		}
+
+		// Flip the assignments along the augmenting path
+		int i;
+		do {
+			i = pred[endOfPath];
+			colsol[endOfPath] = i;
+			int j1 = endOfPath;
+			endOfPath = rowsol[i];
+			rowsol[i] = j1;
+		} while(i != freeRow);
+	}
+}
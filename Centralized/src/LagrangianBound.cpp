@@ -0,0 +1,204 @@
+#include "LagrangianBound.h"
+
+LagrangianBound::LagrangianBound() {
+	m_pInput = NULL;
+	m_pPoissonB = NULL;
+	m_fRoot = 1;
+}
+
+LagrangianBound::~LagrangianBound() {}
+
+/*
+ * Sets the multipliers for input by subgradient descent on the root bound, using
+ * poissonB to evaluate tails. incumbent is the best known Z (0 if none), it sets the
+ * step size and stops the descent once the root bound falls below it.
+ */
+void LagrangianBound::Init(MASPInput* input, PoissonBinomial* poissonB, double incumbent) {
+	m_pInput = input;
+	m_pPoissonB = poissonB;
+	int N = input->getN();
+	int M = input->getM();
+
+	// Agents of each task, most likely first
+	m_vvByP.assign(M, std::vector<int>());
+	for(int j = 0; j < M; j++) {
+		for(int i = 0; i < N; i++) {
+			if(input->iCanDoj(i, j)) {
+				m_vvByP[j].push_back(i);
+			}
+		}
+		std::stable_sort(m_vvByP[j].begin(), m_vvByP[j].end(), [input, j](int a, int b) {
+			return input->get_p_ij(a, j) > input->get_p_ij(b, j);
+		});
+	}
+	m_vPMF.reserve(N + 1);
+	m_vTask.assign(N, -1);
+
+	// Start from lambda = 0, the optimistic bound
+	m_vLambda.assign(N, 0);
+	sortByLambda();
+
+	double target = (incumbent > 0) ? log(incumbent) : -INF;
+	std::vector<double> bestLambda(m_vLambda);
+	double bestL = INF;
+	double theta = 2;
+	int stall = 0;
+	for(int it = 0; it < LAGRANGE_ITERATIONS; it++) {
+		double L = m_vLambda.empty() ? 0 : logBound(m_vTask, true);
+		if(L < bestL - EPSILON*EPSILON) {
+			bestL = L;
+			bestLambda = m_vLambda;
+			stall = 0;
+		}
+		else if(++stall >= LAGRANGE_PATIENCE) {
+			// Overshooting, halve the step and go back to the best multipliers
+			theta /= 2;
+			stall = 0;
+			m_vLambda = bestLambda;
+			sortByLambda();
+			L = logBound(m_vTask, true);
+		}
+
+		if(DEBUG_LAGRANGE)
+			printf("Lagrangian iteration %d: bound = %f, best = %f, theta = %f\n", it, exp(L), exp(bestL), theta);
+
+		// Already below the incumbent (or infeasible), nothing left to gain at the root
+		if(bestL <= target || bestL <= -INF) {
+			break;
+		}
+
+		// Subgradient, leaving out multipliers that are stuck at 0
+		double norm = 0;
+		for(int i = 0; i < N; i++) {
+			double g = 1 - m_vCount[i];
+			if(m_vLambda[i] > 0 || g < 0) {
+				norm += g*g;
+			}
+		}
+		if(norm == 0) {
+			// Every agent charged exactly once, the multipliers are optimal
+			break;
+		}
+
+		// Polyak step towards the incumbent
+		double gap = (target > -INF) ? L - target : 1.0;
+		double step = theta*gap/norm;
+		for(int i = 0; i < N; i++) {
+			m_vLambda[i] = std::max(0.0, m_vLambda[i] - step*(1 - m_vCount[i]));
+		}
+		sortByLambda();
+	}
+
+	// Keep the best multipliers found
+	m_vLambda = bestLambda;
+	sortByLambda();
+	m_fRoot = (bestL <= -INF) ? 0 : exp(bestL);
+
+	if(DEBUG_LAGRANGE) {
+		printf("Lagrangian root bound: %f\nMultipliers:", m_fRoot);
+		for(int i = 0; i < N; i++) {
+			printf(" %f", m_vLambda[i]);
+		}
+		printf("\n");
+	}
+}
+
+// Bound of the current state of engine: assigned agents stay on their task, the rest are free
+double LagrangianBound::Bound(SearchEngine& engine) {
+	for(int i = 0; i < engine.N(); i++) {
+		m_vTask[i] = engine.Task(i);
+	}
+
+	double L = logBound(m_vTask, false);
+	return (L <= -INF) ? 0 : exp(L);
+}
+
+/*
+ * Log of the bound with the current multipliers when agent i is on task[i] (-1 if free).
+ * With record set, m_vCount[i] is the number of tasks whose maximizing subset charged
+ * agent i (the subgradient is 1 - m_vCount[i] for free agents).
+ */
+double LagrangianBound::logBound(const std::vector<int>& task, bool record) {
+	if(record) {
+		m_vCount.assign(task.size(), 0);
+	}
+
+	// Every free agent pays its multiplier once
+	double total = 0;
+	for(unsigned int i = 0; i < task.size(); i++) {
+		if(task[i] < 0) {
+			total += m_vLambda[i];
+		}
+	}
+
+	for(int j = 0; j < m_pInput->getM(); j++) {
+		int d_j = m_pInput->get_d_j(j);
+		const std::vector<int>& byP = m_vvByP[j];
+		const std::vector<int>& byLambda = m_vvByLambda[j];
+
+		// Agents already on j
+		m_vPMF.assign(1, 1.0);
+		for(int a : byP) {
+			if(task[a] == j) {
+				m_pPoissonB->AddTrial(m_vPMF, m_pInput->get_p_ij(a, j));
+			}
+		}
+		double tail = m_pPoissonB->Tail(d_j, m_vPMF);
+		double best = (tail > 0) ? log(tail) : -INF;
+		int bestK = 0;
+
+		// Add the k most likely free agents, charging the k smallest free multipliers
+		double lambdaSum = 0;
+		unsigned int l = 0;
+		int k = 0;
+		for(int a : byP) {
+			if(task[a] >= 0) {
+				continue;
+			}
+			while(task[byLambda[l]] >= 0) {
+				l++;
+			}
+			lambdaSum += m_vLambda[byLambda[l++]];
+			if(-lambdaSum <= best) {
+				// log P_j <= 0, no larger subset can do better
+				break;
+			}
+
+			m_pPoissonB->AddTrial(m_vPMF, m_pInput->get_p_ij(a, j));
+			k++;
+			tail = m_pPoissonB->Tail(d_j, m_vPMF);
+			if(tail > 0 && log(tail) - lambdaSum > best) {
+				best = log(tail) - lambdaSum;
+				bestK = k;
+			}
+		}
+
+		if(best <= -INF) {
+			// Task j can't be covered
+			return -INF;
+		}
+		total += best;
+
+		if(record) {
+			l = 0;
+			for(int c = 0; c < bestK; c++) {
+				while(task[byLambda[l]] >= 0) {
+					l++;
+				}
+				m_vCount[byLambda[l++]]++;
+			}
+		}
+	}
+
+	return total;
+}
+
+// Sorts the agents of each task by increasing multiplier
+void LagrangianBound::sortByLambda() {
+	m_vvByLambda = m_vvByP;
+	for(std::vector<int>& agents : m_vvByLambda) {
+		std::stable_sort(agents.begin(), agents.end(), [this](int a, int b) {
+			return m_vLambda[a] < m_vLambda[b];
+		});
+	}
+}
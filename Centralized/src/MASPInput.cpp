@@ -352,6 +352,49 @@ bool MASPInput::iCanDoj(int i, int j) {
 	}
 }
 
+/*
+ * Groups agents with the same capabilities and p_ij values within tolerance of each
+ * other into classes. Each agent joins the class of the first agent it matches.
+ * agentClass[i] is set to the class of agent i. Returns the number of classes.
+ */
+int MASPInput::AgentClasses(double tolerance, std::vector<int>& agentClass) {
+	// First agent of each class
+	std::vector<int> representative;
+	agentClass.assign(N, -1);
+
+	for(int i = 0; i < N; i++) {
+		for(unsigned int c = 0; c < representative.size() && agentClass[i] < 0; c++) {
+			int a = representative[c];
+			bool same = true;
+			for(int k = 0; k < E && same; k++) {
+				same = (c_ik[i][k] == c_ik[a][k]);
+			}
+			for(int j = 0; j < M && same; j++) {
+				same = (fabs(p_ij[i][j] - p_ij[a][j]) <= tolerance);
+			}
+			if(same) {
+				agentClass[i] = c;
+			}
+		}
+
+		if(agentClass[i] < 0) {
+			// Start a new class
+			agentClass[i] = representative.size();
+			representative.push_back(i);
+		}
+	}
+
+	if(DEBUG_MASPINPUT) {
+		printf("Agent classes:");
+		for(int i = 0; i < N; i++) {
+			printf(" %d", agentClass[i]);
+		}
+		printf("\n");
+	}
+
+	return representative.size();
+}
+
 // Determines a theoretical upper bound on a possible solution
 double MASPInput::UpperBound() {
 	// Sanity print
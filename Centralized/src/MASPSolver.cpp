@@ -5,6 +5,236 @@ MASPSolver::MASPSolver() {
 
 MASPSolver::~MASPSolver() {}
 
+// Also selects the assignment algorithm of mHungAlgo and its threads
+void MASPSolver::SetOptions(const SolverOptions& options) {
+	Solver::SetOptions(options);
+	mHungAlgo.SetMethod(options.nAssignment);
+	mHungAlgo.SetThreads(options.nThreads);
+}
+
+/*
+ * Best-improvement local search over single-agent moves. Repeatedly applies the move
+ * with the largest gain in log(Z) until no move improves the solution in x_ij. Moves
+ * that would drop a task below d_j zero out Z and are never taken from a valid start.
+ * Returns the number of moves made.
+ */
+int MASPSolver::BestImprovementSearch(MASPInput* input, bool** x_ij) {
+	// Build the move cache and the gain table on top of it
+	InitDeltaCache(input, x_ij);
+	MoveGainTable gainTable;
+	gainTable.Build(input, this);
+
+	int moves = 0;
+	int i, j;
+	double gain;
+	while(gainTable.BestMove(&i, &j, &gain) && gain > EPSILON && !StopRequested()) {
+		int from_j = CachedTask(i);
+
+		// Sanity print
+		if(DEBUG_MASPSOLV)
+			printf(" Best move: %d from %d to %d, gain = %f\n", i, from_j, j, gain);
+
+		// Apply the move
+		if(from_j >= 0) {
+			x_ij[i][from_j] = false;
+		}
+		x_ij[i][j] = true;
+		ApplyMove(input, i, from_j, j);
+		gainTable.OnMove(input, this, i, from_j, j);
+		moves++;
+	}
+
+	if(SANITY_PRINT)
+		printf(" Best-improvement search made %d moves, Z = %f\n", moves, CachedZ());
+
+	return moves;
+}
+
+/*
+ * Runs mHungAlgo on costMatrix, recording the call and the time it took in m_stats.
+ * Returns the cost of the assignment.
+ */
+double MASPSolver::solveAssignment(std::vector<std::vector<double>>& costMatrix, std::vector<int>& assignment) {
+	auto start = std::chrono::steady_clock::now();
+	double cost = mHungAlgo.Solve(costMatrix, assignment);
+	auto stop = std::chrono::steady_clock::now();
+
+	m_stats.nHungarianCalls++;
+	m_stats.fAssignmentTime += std::chrono::duration<double>(stop - start).count();
+	if(mHungAlgo.GetMethod() == e_Assign_Auction) {
+		recordAuction(mHungAlgo.GetAuction());
+	}
+
+	return cost;
+}
+
+// Same as above for an nRows x nCols row-major costMatrix, reusing the buffers in workspace
+double MASPSolver::solveAssignment(const double* costMatrix, int nRows, int nCols, std::vector<int>& assignment, HungarianWorkspace& workspace) {
+	auto start = std::chrono::steady_clock::now();
+	double cost = mHungAlgo.Solve(costMatrix, nRows, nCols, assignment, workspace);
+	auto stop = std::chrono::steady_clock::now();
+
+	m_stats.nHungarianCalls++;
+	m_stats.fAssignmentTime += std::chrono::duration<double>(stop - start).count();
+	if(mHungAlgo.GetMethod() == e_Assign_Auction) {
+		recordAuction(workspace.auction);
+	}
+
+	return cost;
+}
+
+/*
+ * Solves the assignment of nRows rows to nCols columns using only the given edges,
+ * recording the call in m_stats. Returns false if some row cannot be assigned.
+ */
+bool MASPSolver::solveSparseAssignment(int nRows, int nCols, const std::vector<SparseEdge_t>& edges, std::vector<int>& assignment) {
+	auto start = std::chrono::steady_clock::now();
+	double cost;
+	bool assigned = m_sparseLAP.Solve(nRows, nCols, edges, assignment, &cost);
+	auto stop = std::chrono::steady_clock::now();
+
+	m_stats.nHungarianCalls++;
+	m_stats.fAssignmentTime += std::chrono::duration<double>(stop - start).count();
+
+	return assigned;
+}
+
+/*
+ * Solves the balanced matching as a transportation problem: each agent goes to one
+ * task and task j gets between d_j and d_j + a_f agents. cost is row-major N x M with
+ * INF marking pairs that cannot be matched. Fills agentTask with each agent's task.
+ * Returns false if no such assignment exists.
+ */
+bool MASPSolver::solveTransportation(MASPInput* input, const std::vector<double>& cost, std::vector<int>& agentTask) {
+	// Time the whole call, infeasible instances included
+	auto start = std::chrono::steady_clock::now();
+	bool solved = transport(input, cost, agentTask);
+	auto stop = std::chrono::steady_clock::now();
+
+	m_stats.nHungarianCalls++;
+	m_stats.fAssignmentTime += std::chrono::duration<double>(stop - start).count();
+
+	return solved;
+}
+
+// Adds the rounds, final epsilon and duality gap of auction's last solve to m_stats
+void MASPSolver::recordAuction(Auction& auction) {
+	m_stats.nAuctionRounds += auction.GetIterations();
+	m_stats.fAuctionEpsilon = std::max(m_stats.fAuctionEpsilon, auction.GetEpsilon());
+	m_stats.fAuctionGap = std::max(m_stats.fAuctionGap, auction.GetGap());
+}
+
+// Body of solveTransportation(), which times it
+bool MASPSolver::transport(MASPInput* input, const std::vector<double>& cost, std::vector<int>& agentTask) {
+	int N = input->getN();
+	int M = input->getM();
+
+	// Determine a_f, the number of floating agents
+	int a_f = N;
+	for(int j = 0; j < M; j++) {
+		a_f -= input->get_d_j(j);
+	}
+	if(a_f < 0) {
+		return false;
+	}
+
+	/*
+	 * Nodes: source, agents, tasks, a shared floating node and the sink. Task j sends d_j
+	 * straight to the sink and anything above that through the floating node, which takes
+	 * at most a_f. The sink's in-capacity is exactly N, so a flow of N fills every d_j.
+	 */
+	int source = 0;
+	int firstAgent = 1;
+	int firstTask = firstAgent + N;
+	int floating = firstTask + M;
+	int sink = floating + 1;
+	m_flow.Reset(sink + 1);
+
+	std::vector<int> agentEdges;
+	std::vector<int> edgeTask;
+	for(int i = 0; i < N; i++) {
+		m_flow.AddEdge(source, firstAgent + i, 1, 0);
+
+		// Every agent is matched once, so shifting its costs by its cheapest task keeps the optimum
+		double minCost = INF;
+		for(int j = 0; j < M; j++) {
+			minCost = std::min(minCost, cost.at(i*M + j));
+		}
+		if(minCost >= INF) {
+			// Agent i can't do anything
+			return false;
+		}
+
+		for(int j = 0; j < M; j++) {
+			if(cost.at(i*M + j) < INF) {
+				agentEdges.push_back(m_flow.AddEdge(firstAgent + i, firstTask + j, 1, cost.at(i*M + j) - minCost));
+				edgeTask.push_back(j);
+			}
+		}
+		// Mark the end of this agent's edges
+		agentEdges.push_back(-1);
+		edgeTask.push_back(-1);
+	}
+	for(int j = 0; j < M; j++) {
+		m_flow.AddEdge(firstTask + j, sink, input->get_d_j(j), 0);
+		if(a_f > 0) {
+			m_flow.AddEdge(firstTask + j, floating, a_f, 0);
+		}
+	}
+	if(a_f > 0) {
+		m_flow.AddEdge(floating, sink, a_f, 0);
+	}
+
+	double flowCost;
+	int flow = m_flow.Solve(source, sink, N, &flowCost);
+
+	// Read each agent's task off its edges
+	agentTask.assign(N, -1);
+	int i = 0;
+	for(unsigned int e = 0; e < agentEdges.size(); e++) {
+		if(agentEdges.at(e) < 0) {
+			i++;
+		}
+		else if(m_flow.Flow(agentEdges.at(e)) > 0) {
+			agentTask.at(i) = edgeTask.at(e);
+		}
+	}
+
+	if(DEBUG_MASPSOLV)
+		printf("Transportation: flow = %d of %d, shifted cost = %f\n", flow, N, flowCost);
+
+	return flow == N;
+}
+
+// Sets the agent/task orders, propagation and, with the symmetry option, the classes of interchangeable agents of engine (after SearchEngine::Init())
+void MASPSolver::configureSearch(MASPInput* input, SearchEngine& engine) {
+	engine.SetOrdering(m_options.nVarOrder, m_options.nValueOrder);
+	engine.SetPropagation(m_options.bPropagate);
+	if(!m_options.bSymmetry) {
+		return;
+	}
+
+	std::vector<int> agentClass;
+	int classes = input->AgentClasses(m_options.fSymmetryTol, agentClass);
+	int tied = engine.SetClasses(agentClass);
+
+	if(SANITY_PRINT)
+		printf(" %d agents in %d classes, %d depths tied to an earlier agent\n", input->getN(), classes, tied);
+}
+
+// Sets up table for dominance pruning if the options ask for it (it needs pruning on and symmetry off), returns whether it is on
+bool MASPSolver::configureDominance(MASPInput* input, TranspositionTable& table) {
+	if(!m_options.bDominance || !m_options.bPruning || m_options.bSymmetry) {
+		return false;
+	}
+
+	// Only agents that are exactly alike share a class, the table is exact
+	std::vector<int> agentClass;
+	input->AgentClasses(0, agentClass);
+	table.Init(input, m_options.fTableMB, agentClass);
+	return true;
+}
+
 // Sets a = min(a, b), returns true if b < a
 bool MASPSolver::ckmin(double* a, double b) {
 	if(b < *a) {
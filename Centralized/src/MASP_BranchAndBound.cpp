@@ -1,12 +1,13 @@
 #include "MASP_BranchAndBound.h"
+#include "SolverRegistry.h"
+
+REGISTER_SOLVER(e_Algo_MASP_BNB, "bnb", MASP_BranchAndBound);
 
 
 MASP_BranchAndBound::MASP_BranchAndBound() {
 	if(SANITY_PRINT)
 		printf("Hello from MASPComp Solver!\n");
 	fGlobalProbSuccess = 0;
-	nInvalidCount = 0;
-	nPruningCount = 0;
 	bGlobalX_ij = NULL;
 }
 
@@ -17,40 +18,37 @@ void MASP_BranchAndBound::Solve(MASPInput* input, I_solution* I_crnt) {
 
 	// Update current best-known solution
 	fGlobalProbSuccess = 0;
-	nInvalidCount = 0;
-	nPruningCount = 0;
+	m_PoissonB.ResetCalls();
 
 	// Create global best solution
 	bGlobalX_ij = new bool*[input->getN()];
-	// Create a local solution space
-	bool** x_ij = new bool*[input->getN()];
 	for(int i = 0; i < input->getN(); i++) {
-		x_ij[i] = new bool[input->getM()];
 		bGlobalX_ij[i] = new bool[input->getM()];
 		for(int j = 0; j < input->getM(); j++) {
-			x_ij[i][j] = false;
 			bGlobalX_ij[i][j] = false;
 		}
 	}
 
-
-	// Find an initial solution using some heuristics-based method
-	MASP_MatchGS heurstcSolver;
-	I_solution I_heur(input);
-	// Run heuristics solver
-	heurstcSolver.Solve(input, &I_heur);
-	// Extract the solution
-	for(int i = 0; i < input->getN(); i++) {
-		int j = I_heur.getTask(i);
-		if(j >= 0) {
-			bGlobalX_ij[i][j] = true;
+	if(m_options.bHeuristicStart) {
+		// Find an initial solution using some heuristics-based method
+		MASP_MatchGS heurstcSolver;
+		heurstcSolver.SetOptions(m_options);
+		I_solution I_heur(input);
+		// Run heuristics solver
+		heurstcSolver.Solve(input, &I_heur);
+		// Extract the solution
+		for(int i = 0; i < input->getN(); i++) {
+			int j = I_heur.getTask(i);
+			if(j >= 0) {
+				bGlobalX_ij[i][j] = true;
+			}
 		}
-	}
 
-	// Benchmark our starting solution
-	fGlobalProbSuccess = BenchmarkCF(input, bGlobalX_ij);
-	if(SANITY_PRINT) {
-		printf(" Heuristic solution Z = %f\n", fGlobalProbSuccess);
+		// Benchmark our starting solution
+		fGlobalProbSuccess = BenchmarkCF(input, bGlobalX_ij);
+		if(SANITY_PRINT) {
+			printf(" Heuristic solution Z = %f\n", fGlobalProbSuccess);
+		}
 	}
 
 	// Collect agents into a list - used for reordering later on
@@ -94,7 +92,9 @@ void MASP_BranchAndBound::Solve(MASPInput* input, I_solution* I_crnt) {
 		oldRecStateSize = countRecursiveStates(sortedAgents);
 	}
 
-	std::sort(sortedAgents.begin(), sortedAgents.end());
+	if(m_options.bSortAgents) {
+		std::sort(sortedAgents.begin(), sortedAgents.end());
+	}
 
 	if(SANITY_PRINT) {
 		// Record new number of recursive calls
@@ -119,8 +119,14 @@ void MASP_BranchAndBound::Solve(MASPInput* input, I_solution* I_crnt) {
 		}
 	}
 
-	// Start recursive solver
-	assign_next(input, 0, x_ij, I_crnt, sortedAgents);
+	// Start the search
+	std::vector<int> order;
+	for(BnBAgent_t agent : sortedAgents) {
+		order.push_back(agent.agent_i);
+	}
+	m_engine.Init(input, order, false, NULL);
+	configureSearch(input, m_engine);
+	m_engine.Run(*this);
 
 	// Sanity print
 	if(DEBUG_MASP_BNB) {
@@ -147,10 +153,6 @@ void MASP_BranchAndBound::Solve(MASPInput* input, I_solution* I_crnt) {
 		I_crnt->PrintSolution();
 
 	// Free memory
-	for(int i = 0; i < input->getN(); i++) {
-		delete[] x_ij[i];
-	}
-	delete[] x_ij;
 	for(int i = 0; i < input->getN(); i++) {
 		delete[] bGlobalX_ij[i];
 	}
@@ -160,141 +162,88 @@ void MASP_BranchAndBound::Solve(MASPInput* input, I_solution* I_crnt) {
 		printf(" * finished\n");
 		printf("--------------------------------------------------------\n");
 		printf("Final solution: %f\n", fGlobalProbSuccess);
-		printf("Invalid solutions found: %ld\n", nInvalidCount);
-		printf("Pruning count: %ld\n\n", nPruningCount);
+		printf("Invalid solutions found: %ld\n", m_stats.nInvalidLeaves);
+		printf("Pruning count: %ld\n\n", m_stats.nPruneBound);
 	}
+
+	// Record bound evaluations
+	m_stats.nPMFCalls += m_PoissonB.Calls();
+	m_stats.nForced += m_engine.Forced();
+	m_stats.nPrunePropagation += m_engine.Failed();
 }
 
-// i is the index into the agentMap - not the actual agents ID!
-void MASP_BranchAndBound::assign_next(MASPInput* input, int i, bool** x_ij, I_solution* I_crnt, std::vector<BnBAgent_t>& agentMap) {
-	// Check base case
-	if(i >= input->getN()) {
-		/// Hit base case
-		// Verify this is a valid assignment
-		if(valid_solution(input, x_ij)) {
-			// Determine Z
-			double Z = BenchmarkCF(input, x_ij);
-
-			// Is this better than our best solution?
-			if(Z > fGlobalProbSuccess) {
-				// Sanity print
-				if(SANITY_PRINT)
-					printf(" * found improved solution: Z(I, C) = %f\n", Z);
-
-				// Update best found solution
-				fGlobalProbSuccess = Z;
-				for(int i = 0; i < input->getN(); i++) {
-					for(int j = 0; j < input->getM(); j++) {
-						bGlobalX_ij[i][j] = x_ij[i][j];
-					}
-				}
-			}
-			else {
-				// Sanity print
-				if(DEBUG_MASP_BNB)
-					printf("Z(I, C) = %f\n", Z);
-			}
-		}
-		else {
-			// ELSE do nothing, not valid
-			nInvalidCount++;
-		}
+// Search hook: out of time? Stop and keep the incumbent
+bool MASP_BranchAndBound::OnNode(SearchEngine& engine) {
+	if(StopRequested()) {
+		return false;
 	}
-	else {
-		/// Recursive case
-		// Determine i for recursive step input
-		int next_i = i + 1;
-		// Iterate through all possible assignments of x_ij for input i
-		for(int j = 0; j < input->getM(); j++) {
-			// Verify that i meets the requirements of j
-			if(input->iCanDoj(agentMap.at(i).agent_i, j)) {
-				// Assign agent i to task j
-				x_ij[agentMap.at(i).agent_i][j] = true;
-				bool keepBranch = true;
-
-				// Pruning by solution existence
-				if(keepBranch) {
-					// We only consider the set of unassigned agents (we just assigned i)
-					int next_to_assign = i+1;
-					int agents = input->getN() - next_to_assign;
-
-					// Are there still any agents left un-assigned? (conversely, was i the last agent..?)
-					if(agents > 0) {
-
-						// Make a local copy of d_j
-						std::vector<int> local_d_j;
-						for(int local_j = 0; local_j < input->getM(); local_j++) {
-							local_d_j.push_back(input->get_d_j(local_j));
-						}
-
-						// Determine how many tasks STILL require agents
-						for(int local_i = 0; local_i < input->getN()-agents; local_i++) {
-							// Determine which task this agent was assigned to
-							for(int local_j = 0; local_j < input->getM(); local_j++) {
-								int agent_i = agentMap.at(local_i).agent_i;
-								if(x_ij[agent_i][local_j]) {
-									local_d_j.at(local_j) = std::max(0, local_d_j.at(local_j) - 1);
-								}
-							}
-						}
-
-						// Determine a_r, the number of required agents
-						int a_r = 0;
-						for(int local_j = 0; local_j < input->getM(); local_j++) {
-							a_r += local_d_j.at(local_j);
-						}
-
-						// Do we have enough agents...?
-						if(a_r > agents) {
-							// There aren't enough vacant agents to fill all requirements..
-							keepBranch = false;
-
-							// Sanity print
-							if(DEBUG_MASP_BNB) {
-								printf("Not enough agents here:\nd_j:\n");
-								for(int j = 0; j < input->getM(); j++) {
-									printf("%d ", input->get_d_j(j));
-								}
-								printf("\nNumber not assigned: %d, number still needed: %d\n-- Prune by requirements --\n", agents, a_r);
-							}
-						}
-					}
-				}
+	m_stats.nNodes++;
+	return true;
+}
 
-				// Should we recurse on this branch?
-				if(keepBranch) {
-					// Increment i and recurse
-					assign_next(input, next_i, x_ij, I_crnt, agentMap);
-				}
+// Search hook: decides whether to search below the agent at depth i taking task j
+bool MASP_BranchAndBound::OnAssign(SearchEngine& engine, int i, int j) {
+	MASPInput* input = engine.Input();
+
+	if(DEBUG_MASP_BNB) {
+		printf("-- Pruning check --\n");
+	}
 
-				// Reset i/j combo
-				x_ij[agentMap.at(i).agent_i][j] = false;
+	// Pruning by requirements: are there enough unassigned agents for the demand still uncovered?
+	int agents = engine.Unassigned();
+	if(agents > 0 && engine.Required() > agents) {
+		// There aren't enough vacant agents to fill all requirements..
+		m_stats.nPruneRequirements++;
+
+		// Sanity print
+		if(DEBUG_MASP_BNB) {
+			printf("Not enough agents here:\nd_j:\n");
+			for(int j = 0; j < input->getM(); j++) {
+				printf("%d ", input->get_d_j(j));
 			}
+			printf("\nNumber not assigned: %d, number still needed: %d\n-- Prune by requirements --\n", agents, engine.Required());
 		}
+		return false;
 	}
+
+	return true;
 }
 
-// Determine if this is a valid solution
-bool MASP_BranchAndBound::valid_solution(MASPInput* input, bool** x_ij) {
-	// Count the number of agents assigned to each task
-	for(int j = 0; j < input->getM(); j++) {
-		int agent_count = 0;
-		// Cycle through all agents
-		for(int i = 0; i < input->getN(); i++) {
-			if(x_ij[i][j]) {
-				agent_count++;
+// Search hook: scores a complete assignment
+void MASP_BranchAndBound::OnLeaf(SearchEngine& engine) {
+	MASPInput* input = engine.Input();
+	bool** x_ij = engine.X();
+
+	// Verify this is a valid assignment
+	if(engine.Covered()) {
+		// Determine Z
+		double Z = BenchmarkCF(input, x_ij);
+		m_stats.nLeaves++;
+
+		// Is this better than our best solution?
+		if(Z > fGlobalProbSuccess) {
+			// Sanity print
+			if(SANITY_PRINT)
+				printf(" * found improved solution: Z(I, C) = %f\n", Z);
+
+			// Update best found solution
+			fGlobalProbSuccess = Z;
+			for(int i = 0; i < input->getN(); i++) {
+				for(int j = 0; j < input->getM(); j++) {
+					bGlobalX_ij[i][j] = x_ij[i][j];
+				}
 			}
 		}
-
-		// Check if we assigned enough agents to this task
-		if(agent_count < input->get_d_j(j)) {
-			// Not enough agents assigned to this task
-			return false;
+		else {
+			// Sanity print
+			if(DEBUG_MASP_BNB)
+				printf("Z(I, C) = %f\n", Z);
 		}
 	}
-
-	// If we make it this far, all tasks must have enough agents
-	return true;
+	else {
+		// ELSE do nothing, not valid
+		m_stats.nInvalidLeaves++;
+	}
 }
 
 // Counts the number of recursive states required to iterate through (just FYI)
@@ -312,61 +261,4 @@ long int MASP_BranchAndBound::countRecursiveStates(std::vector<BnBAgent_t>& agen
 
 
 
-// Takes balanced matching index and converts it into the corresponding agent's index.
-// Returns -1 if this is a phantom
-int MASP_BranchAndBound::get_agent(int i, int N) {
-	if(i < N) {
-		return i;
-	}
-
-	// This is a phantom agent
-	return -1;
-}
-
-// Takes balanced matching index and converts it into the corresponding task's index
-int MASP_BranchAndBound::get_task(int bal_j, int M, int a_f, std::vector<int>& d_j) {
-	int run_j = 0;
-	for(int j = 0; j < M; j++) {
-		for(int i = 0; i < d_j.at(j); i++) {
-			if(bal_j == run_j) {
-				return j;
-			}
-			run_j++;
-		}
-		for(int i = 0; i < a_f; i++) {
-			if(bal_j == run_j) {
-				return j;
-			}
-			run_j++;
-		}
-	}
-
-	// If you made it here... something went wrong -> hard fail!
-	fprintf(stderr, "[MASP_BalMatch::get_task] : Could not find mapping from bal_j to task_j, bal_j = %d\n", bal_j);
-	exit(1);
-}
-
-// Determines if this is a floating task
-bool MASP_BranchAndBound::floating_task(int bal_j, int M, int a_f, std::vector<int>& d_j) {
-	int run_j = 0;
-	for(int j = 0; j < M; j++) {
-		for(int i = 0; i < d_j.at(j); i++) {
-			if(bal_j == run_j) {
-				return false;
-			}
-			run_j++;
-		}
-		for(int i = 0; i < a_f; i++) {
-			if(bal_j == run_j) {
-				return true;
-			}
-			run_j++;
-		}
-	}
-
-	// If you made it here... something went wrong -> hard fail!
-	fprintf(stderr, "[MASP_BalMatch::floating_task] : Could not find mapping from bal_j to task_j, bal_j = %d\n", bal_j);
-	exit(1);
-}
-
 
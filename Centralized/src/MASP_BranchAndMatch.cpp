@@ -1,13 +1,53 @@
 #include "MASP_BranchAndMatch.h"
+#include "SolverRegistry.h"
 
+REGISTER_SOLVER(e_Algo_MASP_BNM, "bnm", MASP_BranchAndMatch);
+
+BnMContext_t::BnMContext_t(int thread, MASPInput* input, MASP_BranchAndMatch* solver) {
+	nThread = thread;
+	pSolver = solver;
+
+	// Set up the per-depth matchings (nothing matched yet) and remaining demand
+	vvMatching.assign(input->getN() + 1, std::vector<int>(input->getN(), -1));
+	vvDemand.assign(input->getN() + 1, std::vector<int>());
+	for(int j = 0; j < input->getM(); j++) {
+		vvDemand.at(0).push_back(input->get_d_j(j));
+	}
+	vvTaskAgents.assign(input->getM(), std::vector<int>());
+}
+
+BnMContext_t::~BnMContext_t() {}
+
+bool BnMContext_t::OnNode(SearchEngine& engine) {
+	return pSolver->on_node(*this);
+}
+
+bool BnMContext_t::OnAssign(SearchEngine& engine, int i, int j) {
+	return pSolver->on_assign(*this, i, j);
+}
+
+void BnMContext_t::OnLeaf(SearchEngine& engine) {
+	pSolver->on_leaf(*this);
+}
+
+void BnMContext_t::OnReplay(SearchEngine& engine, int i, int j) {
+	// Rebuild the matching of the node, every check passed when the path was searched
+	if(i + 1 < engine.N()) {
+		pSolver->matching_exists(*this, engine.Input(), i, j);
+	}
+}
 
 MASP_BranchAndMatch::MASP_BranchAndMatch() {
 	if(SANITY_PRINT)
 		printf("Hello from MASPComp Solver!\n");
 	fGlobalProbSuccess = 0;
-	nInvalidCount = 0;
-	nPruningCount = 0;
 	bGlobalX_ij = NULL;
+	m_bParallel = false;
+	m_nSplitDepth = 0;
+	m_bBestFirst = false;
+	m_nFrontierBytes = 0;
+	m_bCheckpoint = false;
+	m_bDominance = false;
 }
 
 
@@ -17,40 +57,63 @@ void MASP_BranchAndMatch::Solve(MASPInput* input, I_solution* I_crnt) {
 
 	// Update current best-known solution
 	fGlobalProbSuccess = 0;
-	nInvalidCount = 0;
-	nPruningCount = 0;
 
 	// Create global best solution
 	bGlobalX_ij = new bool*[input->getN()];
-	// Create a local solution space
-	bool** x_ij = new bool*[input->getN()];
 	for(int i = 0; i < input->getN(); i++) {
-		x_ij[i] = new bool[input->getM()];
 		bGlobalX_ij[i] = new bool[input->getM()];
 		for(int j = 0; j < input->getM(); j++) {
-			x_ij[i][j] = false;
 			bGlobalX_ij[i][j] = false;
 		}
 	}
 
+	// A resumed search starts from the incumbent of its checkpoint
+	m_bCheckpoint = !m_options.sCheckpoint.empty();
+	bool resumed = false;
+	if(m_bCheckpoint) {
+		if(m_options.nThreads > 1 || m_options.nSearch != e_Search_DepthFirst) {
+			fprintf(stderr, "[ERROR][MASP_BranchAndMatch::Solve] : Checkpoints need the serial depth-first search (--threads=1 --search=dfs)\n");
+			exit(1);
+		}
+		resumed = m_options.bResume && load_checkpoint(input);
+	}
+	else if(m_options.bResume) {
+		fprintf(stderr, "[ERROR][MASP_BranchAndMatch::Solve] : --resume needs a --checkpoint file\n");
+		exit(1);
+	}
 
-	// Find an initial solution using some heuristics-based method
-	MASP_MatchGS heurstcSolver;
-	I_solution I_heur(input);
-	// Run heuristics solver
-	heurstcSolver.Solve(input, &I_heur);
-	// Extract the solution
-	for(int i = 0; i < input->getN(); i++) {
-		int j = I_heur.getTask(i);
-		if(j >= 0) {
-			bGlobalX_ij[i][j] = true;
+	if(resumed) {
+		fGlobalProbSuccess = m_checkpoint.fIncumbent;
+		for(int i = 0; i < input->getN(); i++) {
+			int j = m_checkpoint.vIncumbent.at(i);
+			if(j >= 0) {
+				bGlobalX_ij[i][j] = true;
+			}
+		}
+		if(SANITY_PRINT) {
+			printf(" Resuming at depth %zu, Z = %f\n", m_checkpoint.vPath.size(), fGlobalProbSuccess.load());
 		}
 	}
+	else if(m_options.bHeuristicStart) {
+		// Find an initial solution using some heuristics-based method
+		MASP_MatchGS heurstcSolver;
+		heurstcSolver.SetOptions(m_options);
+		I_solution I_heur(input);
+		// Run heuristics solver
+		heurstcSolver.Solve(input, &I_heur);
+		// Extract the solution
+		for(int i = 0; i < input->getN(); i++) {
+			int j = I_heur.getTask(i);
+			if(j >= 0) {
+				bGlobalX_ij[i][j] = true;
+			}
+		}
 
-	// Benchmark our starting solution
-	fGlobalProbSuccess = BenchmarkCF(input, bGlobalX_ij);
-	if(SANITY_PRINT) {
-		printf(" Heuristic solution Z = %f\n", fGlobalProbSuccess);
+		// Benchmark our starting solution
+		fGlobalProbSuccess = BenchmarkCF(input, bGlobalX_ij);
+		if(SANITY_PRINT) {
+			printf(" Heuristic solution Z = %f\n", fGlobalProbSuccess.load());
+		}
 	}
 
 	// Collect agents into a list - used for reordering later on
@@ -94,7 +157,9 @@ void MASP_BranchAndMatch::Solve(MASPInput* input, I_solution* I_crnt) {
 		oldRecStateSize = countRecursiveStates(sortedAgents);
 	}
 
-	std::sort(sortedAgents.begin(), sortedAgents.end());
+	if(m_options.bSortAgents) {
+		std::sort(sortedAgents.begin(), sortedAgents.end());
+	}
 
 	if(SANITY_PRINT) {
 		// Record new number of recursive calls
@@ -119,12 +184,121 @@ void MASP_BranchAndMatch::Solve(MASPInput* input, I_solution* I_crnt) {
 		}
 	}
 
-	// Start recursive solver
-	assign_next(input, 0, x_ij, I_crnt, sortedAgents);
+	// Tasks each agent can do, shared by the search threads
+	m_vvCanDo.assign(input->getN(), std::vector<int>());
+	for(int k = 0; k < input->getN(); k++) {
+		for(int j = 0; j < input->getM(); j++) {
+			if(input->iCanDoj(k, j)) {
+				m_vvCanDo.at(k).push_back(j);
+			}
+		}
+	}
+
+	// One search context per thread, all walk the agents in sorted order
+	std::vector<int> order;
+	for(BnMAgent_t agent : sortedAgents) {
+		order.push_back(agent.agent_i);
+	}
+	int nThreads = std::max(1, std::min(m_options.nThreads, input->getN()));
+
+	if(m_bCheckpoint) {
+		// Options that shape the tree (symmetry-tol to 1e-9), a resumed search must have the same and the same agent order
+		std::vector<int> options = {m_options.bSortAgents, m_options.nVarOrder, m_options.nValueOrder, m_options.bPruning,
+				m_options.nBound, m_options.bSymmetry, (int)llround(m_options.fSymmetryTol*1e9), m_options.bPropagate};
+		if(resumed && (options != m_checkpoint.vOptions || order != m_checkpoint.vOrder)) {
+			fprintf(stderr, "[ERROR][MASP_BranchAndMatch::Solve] : Checkpoint \"%s\" was saved with other search options\n", m_options.sCheckpoint.c_str());
+			exit(1);
+		}
+		m_checkpoint.nInputHash = Checkpoint::InputHash(input);
+		m_checkpoint.nN = input->getN();
+		m_checkpoint.nM = input->getM();
+		m_checkpoint.vOptions = options;
+		m_checkpoint.vOrder = order;
+		m_nextCheckpoint = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>(m_options.fCheckpointEvery));
+	}
+
+	m_vContexts.clear();
+	for(int t = 0; t < nThreads; t++) {
+		m_vContexts.push_back(std::unique_ptr<BnMContext_t>(new BnMContext_t(t, input, this)));
+		BnMContext_t& ctx = *m_vContexts.back();
+		ctx.engine.Init(input, order, true, &ctx.poissonB);
+		configureSearch(input, ctx.engine);
+		if(m_options.bPruning && m_options.nBound == e_Bound_Lagrangian) {
+			ctx.lagrangian.Init(input, &ctx.poissonB, fGlobalProbSuccess);
+		}
+	}
+	if(SANITY_PRINT && m_options.bPruning && m_options.nBound == e_Bound_Lagrangian) {
+		printf(" Lagrangian root bound: %f\n", m_vContexts.at(0)->lagrangian.Root());
+	}
+
+	// The best-first search keeps a single frontier and runs on one thread
+	m_bBestFirst = m_options.nSearch == e_Search_BestFirst;
+	m_bParallel = nThreads > 1 && !m_bBestFirst;
+	// Dominance needs every stored state searched before the states it prunes, which only the serial depth-first search guarantees
+	m_bDominance = !m_bBestFirst && !m_bParallel && configureDominance(input, m_table);
+	if(m_bBestFirst) {
+		run_best_first(*m_vContexts.at(0), input);
+	}
+	else if(!m_bParallel) {
+		BnMContext_t& ctx = *m_vContexts.at(0);
+		bool finished = true;
+		if(resumed) {
+			// Pick the search up where the checkpoint left it, counters included
+			ctx.stats = m_checkpoint.stats;
+			if(!m_checkpoint.bDone) {
+				if(!ctx.engine.Restore(ctx, m_checkpoint.vPath, m_checkpoint.vNext)) {
+					fprintf(stderr, "[ERROR][MASP_BranchAndMatch::Solve] : Checkpoint \"%s\" doesn't fit this search\n", m_options.sCheckpoint.c_str());
+					exit(1);
+				}
+				finished = ctx.engine.Resume(ctx);
+			}
+		}
+		else {
+			// Start the search
+			finished = ctx.engine.Run(ctx);
+		}
+
+		if(m_bCheckpoint && finished) {
+			// Resuming from here only returns the result
+			save_checkpoint(ctx, true);
+		}
+	}
+	else {
+		// Split at the first depth with enough nodes to keep every thread busy
+		m_nSplitDepth = 1;
+		double nodes = sortedAgents.at(0).branchFactor;
+		while(m_nSplitDepth < input->getN() - 1 && nodes < BNM_TASKS_PER_THREAD*nThreads) {
+			nodes *= sortedAgents.at(m_nSplitDepth).branchFactor;
+			m_nSplitDepth++;
+		}
+		if(SANITY_PRINT)
+			printf(" Searching on %d threads, split depth %d\n", nThreads, m_nSplitDepth);
+
+		// The root is the first task, the search hands out the nodes below it from there
+		m_pool.Reset(nThreads);
+		std::vector<int> root;
+		m_pool.Push(0, [this, input, root](int t) {
+			run_subtree(*m_vContexts.at(t), input, root);
+		});
+		m_pool.Run();
+
+		if(SANITY_PRINT)
+			printf(" Ran %ld tasks, %ld stolen\n", m_pool.Executed(), m_pool.Steals());
+	}
+
+	// Merge the counters of the search threads
+	for(std::unique_ptr<BnMContext_t>& ctx : m_vContexts) {
+		ctx->stats.nPMFCalls += ctx->poissonB.Calls();
+		ctx->stats.nForced += ctx->engine.Forced();
+		ctx->stats.nPrunePropagation += ctx->engine.Failed();
+		m_stats.Add(ctx->stats);
+	}
+	m_vContexts.clear();
 
 	// Sanity print
 	if(DEBUG_MASP_BNM) {
-		printf("\nBest found solution: Z(I, C) = %f\n", fGlobalProbSuccess);
+		printf("\nBest found solution: Z(I, C) = %f\n", fGlobalProbSuccess.load());
 		for(int i = 0; i < input->getN(); i++) {
 			for(int j = 0; j < input->getM(); j++) {
 				if(bGlobalX_ij[i][j]) {
@@ -147,10 +321,6 @@ void MASP_BranchAndMatch::Solve(MASPInput* input, I_solution* I_crnt) {
 		I_crnt->PrintSolution();
 
 	// Free memory
-	for(int i = 0; i < input->getN(); i++) {
-		delete[] x_ij[i];
-	}
-	delete[] x_ij;
 	for(int i = 0; i < input->getN(); i++) {
 		delete[] bGlobalX_ij[i];
 	}
@@ -159,23 +329,167 @@ void MASP_BranchAndMatch::Solve(MASPInput* input, I_solution* I_crnt) {
 	if(SANITY_PRINT) {
 		printf(" * finished\n");
 		printf("--------------------------------------------------------\n");
-		printf("Final solution: %f\n", fGlobalProbSuccess);
-		printf("Invalid solutions found: %ld\n", nInvalidCount);
-		printf("Pruning count: %ld\n\n", nPruningCount);
+		printf("Final solution: %f\n", fGlobalProbSuccess.load());
+		printf("Invalid solutions found: %ld\n", m_stats.nInvalidLeaves);
+		printf("Pruning count: %ld\n\n", m_stats.nPruneBound);
+	}
+}
+
+// Search hook: out of time? Stop and keep the incumbent. Saves a checkpoint when one is due.
+bool MASP_BranchAndMatch::on_node(BnMContext_t& ctx) {
+	if(StopRequested()) {
+		if(m_bCheckpoint) {
+			// Save where the search stopped, resuming enters this node again
+			save_checkpoint(ctx, false);
+		}
+		return false;
+	}
+	if(m_bCheckpoint && (ctx.stats.nNodes & BNM_CHECKPOINT_MASK) == 0 && std::chrono::steady_clock::now() >= m_nextCheckpoint) {
+		// Saved before this node is counted, resuming counts it
+		save_checkpoint(ctx, false);
+		m_nextCheckpoint = std::chrono::steady_clock::now() + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+				std::chrono::duration<double>(m_options.fCheckpointEvery));
+	}
+	ctx.stats.nNodes++;
+	return true;
+}
+
+// Search hook: decides whether to search below the agent at depth i taking task j
+bool MASP_BranchAndMatch::on_assign(BnMContext_t& ctx, int i, int j) {
+	MASPInput* input = ctx.engine.Input();
+	bool keepBranch = true;
+
+	// Pruning by requirements: are there enough unassigned agents for the demand still uncovered?
+	int agents = ctx.engine.Unassigned();
+	if(agents > 0 && ctx.engine.Required() > agents) {
+		// There aren't enough vacant agents to fill all requirements..
+		keepBranch = false;
+		ctx.stats.nPruneRequirements++;
+
+		// Sanity print
+		if(DEBUG_MASP_BNM) {
+			printf("Not enough agents here:\nd_j:\n");
+			for(int j = 0; j < input->getM(); j++) {
+				printf("%d ", input->get_d_j(j));
+			}
+			printf("\nNumber not assigned: %d, number still needed: %d\n-- Prune by requirements --\n", agents, ctx.engine.Required());
+		}
 	}
+
+	// Pruning by solution bound
+	double childBound = 1;
+	{
+		// Agents up to i keep their task, every later agent counts towards every task it can do
+		double upperBound = ctx.engine.Bound();
+		childBound = upperBound;
+
+		// Sanity print
+		if(DEBUG_MASP_BNM) {
+			printf("-- Pruning check --\n");
+			printf("Upper-bound: %f, Incumbent solution: %f\n", upperBound, fGlobalProbSuccess.load());
+			printf("-- Prune by bound? %d --\n", (upperBound < fGlobalProbSuccess));
+		}
+
+		// Can we prune this branch?
+		if(m_options.bPruning && upperBound < fGlobalProbSuccess) {
+			// We won't find a better solution by branching here
+			keepBranch = false;
+			ctx.stats.nPruneBound++;
+		}
+		// Try the tighter (and slower) Lagrangian bound only when the optimistic one keeps the branch
+		else if(m_options.bPruning && m_options.nBound == e_Bound_Lagrangian && keepBranch && agents > 0) {
+			upperBound = ctx.lagrangian.Bound(ctx.engine);
+			childBound = std::min(childBound, upperBound);
+			if(DEBUG_MASP_BNM)
+				printf("Lagrangian upper-bound: %f\n", upperBound);
+
+			if(upperBound < fGlobalProbSuccess) {
+				keepBranch = false;
+				ctx.stats.nPruneBound++;
+			}
+		}
+	}
+
+	// Pruning by dominance: a searched state with the same agents left does at least as well on every task
+	bool store = false;
+	if(keepBranch && m_bDominance && agents > 0) {
+		if(m_table.Dominated(ctx.engine)) {
+			keepBranch = false;
+			ctx.stats.nPruneDominance++;
+		}
+		else {
+			store = true;
+		}
+	}
+
+	// Pruning by solution existence
+	if(keepBranch && agents > 0) {
+		// Can the unassigned agents still cover what every task needs?
+		if(!matching_exists(ctx, input, i, j)) {
+			keepBranch = false;
+			ctx.stats.nPruneMatching++;
+
+			// Sanity print
+			if(DEBUG_MASP_BNM) {
+				printf("No valid matching exists here:\nd_j:\n");
+				for(int local_j = 0; local_j < input->getM(); local_j++) {
+					printf("%d ", ctx.vvDemand.at(i+1).at(local_j));
+				}
+				printf("\n-- Prune by matching --\n");
+			}
+		}
+		else {
+			// Sanity print
+			if(DEBUG_MASP_BNM) {
+				printf("-- Explore this branch --\n");
+			}
+		}
+	}
+
+	if(keepBranch && store) {
+		// This state will be searched next
+		m_table.Store();
+	}
+
+	if(keepBranch && m_bBestFirst && i + 1 < input->getN()) {
+		// Keep the child open while the frontier has room, otherwise search it depth-first now
+		BnMOpen_t open;
+		open.bound = childBound;
+		ctx.engine.Path(open.path);
+		if(m_nFrontierBytes + open.Bytes() <= m_options.fFrontierMB*1024*1024) {
+			m_nFrontierBytes += open.Bytes();
+			m_frontier.push(std::move(open));
+			keepBranch = false;
+		}
+	}
+
+	if(keepBranch && m_bParallel && spawn_child(i + 1)) {
+		// Hand the child to the pool, whichever thread picks it up replays the path
+		std::vector<int> path;
+		ctx.engine.Path(path);
+		m_pool.Push(ctx.nThread, [this, input, path](int t) {
+			run_subtree(*m_vContexts.at(t), input, path);
+		});
+		keepBranch = false;
+	}
+
+	return keepBranch;
 }
 
-// i is the index into the agentMap - not the actual agents ID!
-void MASP_BranchAndMatch::assign_next(MASPInput* input, int i, bool** x_ij, I_solution* I_crnt, std::vector<BnMAgent_t>& agentMap) {
-	// Check base case
-	if(i >= input->getN()) {
-		/// Hit base case
-		// Verify this is a valid assignment
-		if(valid_solution(input, x_ij)) {
-			// Determine Z
-			double Z = BenchmarkCF(input, x_ij);
-
-			// Is this better than our best solution?
+// Search hook: scores a complete assignment
+void MASP_BranchAndMatch::on_leaf(BnMContext_t& ctx) {
+	MASPInput* input = ctx.engine.Input();
+	bool** x_ij = ctx.engine.X();
+
+	// Verify this is a valid assignment
+	if(ctx.engine.Covered()) {
+		// Determine Z
+		double Z = BenchmarkCF(input, x_ij, ctx.poissonB);
+		ctx.stats.nLeaves++;
+
+		// Is this better than our best solution? (check again once no other thread can update it)
+		if(Z > fGlobalProbSuccess) {
+			std::lock_guard<std::mutex> lock(m_incumbentMutex);
 			if(Z > fGlobalProbSuccess) {
 				// Sanity print
 				if(SANITY_PRINT)
@@ -189,383 +503,196 @@ void MASP_BranchAndMatch::assign_next(MASPInput* input, int i, bool** x_ij, I_so
 					}
 				}
 			}
-			else {
-				// Sanity print
-				if(DEBUG_MASP_BNM)
-					printf("Z(I, C) = %f\n", Z);
-			}
 		}
 		else {
-			// ELSE do nothing, not valid
-			nInvalidCount++;
+			// Sanity print
+			if(DEBUG_MASP_BNM)
+				printf("Z(I, C) = %f\n", Z);
 		}
 	}
 	else {
-		/// Recursive case
-		// Determine i for recursive step input
-		int next_i = i + 1;
-		// Iterate through all possible assignments of x_ij for input i
-		for(int j = 0; j < input->getM(); j++) {
-			// Verify that i meets the requirements of j
-			if(input->iCanDoj(agentMap.at(i).agent_i, j)) {
-				// Assign agent i to task j
-				x_ij[agentMap.at(i).agent_i][j] = true;
-				bool keepBranch = true;
-
-				// Pruning by requirements
-				if(keepBranch) {
-					// We only consider the set of unassigned agents (we just assigned i)
-					int next_to_assign = i+1;
-					int agents = input->getN() - next_to_assign;
-
-					// Are there still any agents left un-assigned? (conversely, was i the last agent..?)
-					if(agents > 0) {
-
-						// Make a local copy of d_j
-						std::vector<int> local_d_j;
-						for(int local_j = 0; local_j < input->getM(); local_j++) {
-							local_d_j.push_back(input->get_d_j(local_j));
-						}
-
-						// Determine how many tasks STILL require agents
-						for(int local_i = 0; local_i < input->getN()-agents; local_i++) {
-							// Determine which task this agent was assigned to
-							for(int local_j = 0; local_j < input->getM(); local_j++) {
-								int agent_i = agentMap.at(local_i).agent_i;
-								if(x_ij[agent_i][local_j]) {
-									local_d_j.at(local_j) = std::max(0, local_d_j.at(local_j) - 1);
-								}
-							}
-						}
-
-						// Determine a_r, the number of required agents
-						int a_r = 0;
-						for(int local_j = 0; local_j < input->getM(); local_j++) {
-							a_r += local_d_j.at(local_j);
-						}
-
-						// Do we have enough agents...?
-						if(a_r > agents) {
-							// There aren't enough vacant agents to fill all requirements..
-							keepBranch = false;
-
-							// Sanity print
-							if(DEBUG_MASP_BNM) {
-								printf("Not enough agents here:\nd_j:\n");
-								for(int j = 0; j < input->getM(); j++) {
-									printf("%d ", input->get_d_j(j));
-								}
-								printf("\nNumber not assigned: %d, number still needed: %d\n-- Prune by requirements --\n", agents, a_r);
-							}
-						}
-					}
-				}
+		// ELSE do nothing, not valid
+		ctx.stats.nInvalidLeaves++;
+	}
+}
 
-				// Pruning by solution bound
-				{
-					// Search for a theoretical upper bound based on our current assignment
-					double upperBound = 1;
-					// Start by making a new solution space
-					bool** xp_ij = new bool*[input->getN()];
-					for(int i = 0; i < input->getN(); i++) {
-						xp_ij[i] = new bool[input->getM()];
-						for(int j = 0; j < input->getM(); j++) {
-							xp_ij[i][j] = false;
-						}
-					}
+// Replays path in ctx (from the root) and searches the subtree below it
+void MASP_BranchAndMatch::run_subtree(BnMContext_t& ctx, MASPInput* input, const std::vector<int>& path) {
+	// Every check passed when the path was recorded and the matching is deterministic, so
+	// this rebuilds the same per-depth matchings
+	for(unsigned int k = 0; k < path.size(); k++) {
+		ctx.engine.Push(path.at(k));
+		if((int)k + 1 < input->getN()) {
+			matching_exists(ctx, input, k, path.at(k));
+		}
+	}
 
-					// Create an i to j mapping where any i' that can do j is assigned to j, for i' > input-i
-					for(int ii = 0; ii < input->getN(); ii++) {
-						int agent_i = agentMap.at(ii).agent_i;
-						// Have we already assigned ii in input solution x_ij?
-						if(ii <= i) {
-							// Copy over the current assignment
-							for(int j = 0; j < input->getM(); j++) {
-								if(x_ij[agent_i][j]) {
-									xp_ij[agent_i][j] = true;
-								}
-							}
-						}
-						else {
-							// Check which tasks ii can do
-							for(int j = 0; j < input->getM(); j++) {
-								// Can i do j?
-								if(input->iCanDoj(agent_i, j)) {
-									xp_ij[agent_i][j] = true;
-								}
-								else {
-									xp_ij[agent_i][j] = false;
-								}
-							}
-						}
-					}
+	ctx.engine.Run(ctx);
 
-					// Sanity print
-					if(DEBUG_MASP_BNM) {
-						printf("-- Pruning check --\nxp_ij:\n");
-						for(int i = 0; i < input->getN(); i++) {
-							for(int j = 0; j < input->getM(); j++) {
-								printf(" %d", xp_ij[i][j]);
-							}
-							printf("\n");
-						}
-					}
+	// Back to the root for the next subtree
+	for(unsigned int k = 0; k < path.size(); k++) {
+		ctx.engine.Pop();
+	}
+}
 
-					// Determine the probability that each task is complete
-					for(int j = 0; j < input->getM(); j++) {
-						double prob_j = 0;
-						// Get the number of agents/probabilities of completion for this task
-						std::vector<double> p_values;
-						int agentsAssignedToTask = 0;
-						for(int i = 0; i < input->getN(); i++) {
-							if(xp_ij[i][j]) {
-								agentsAssignedToTask++;
-								p_values.push_back(input->get_p_ij(i, j));
-							}
-						}
-						for(int k = input->get_d_j(j); k <= agentsAssignedToTask; k++) {
-							// Find probability that exactly k agents complete task j
-							prob_j += m_PoissonB.PMF(k, agentsAssignedToTask, p_values);
-						}
-						upperBound *= prob_j;
-					}
+/*
+ * Best-first search from the root on ctx. Searching an open node puts its children back on
+ * the frontier (see on_assign()). The highest bound on the frontier is the bound of the
+ * whole search, so the search stops once it is below the incumbent (optimal) or within the
+ * target gap of it. The next node is often a child of the last one, so the engine only
+ * backs up to the common part of their paths instead of replaying from the root.
+ */
+void MASP_BranchAndMatch::run_best_first(BnMContext_t& ctx, MASPInput* input) {
+	m_frontier = std::priority_queue<BnMOpen_t>();
+	m_nFrontierBytes = 0;
+	m_start = std::chrono::steady_clock::now();
+	m_lastReport = m_start;
+
+	// Path the engine is at
+	std::vector<int> current;
+
+	BnMOpen_t root;
+	root.bound = 1;
+	m_nFrontierBytes += root.Bytes();
+	m_frontier.push(root);
+
+	while(!m_frontier.empty()) {
+		BnMOpen_t open = m_frontier.top();
+		m_frontier.pop();
+		m_nFrontierBytes -= open.Bytes();
+
+		// Nothing left that can beat the incumbent?
+		if(m_options.bPruning && open.bound < fGlobalProbSuccess) {
+			ctx.stats.nPruneBound += 1 + m_frontier.size();
+			m_frontier = std::priority_queue<BnMOpen_t>();
+			m_nFrontierBytes = 0;
+			break;
+		}
 
-					// Sanity print
-					if(DEBUG_MASP_BNM) {
-						printf("Upper-bound: %f, Incumbent solution: %f\n", upperBound, fGlobalProbSuccess);
-						printf("-- Prune by bound? %d --\n", (upperBound < fGlobalProbSuccess));
-					}
+		// Close enough?
+		double gap = (open.bound - fGlobalProbSuccess)/open.bound;
+		if(m_options.fGapReport > 0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - m_lastReport).count() >= m_options.fGapReport) {
+			report_gap(open.bound);
+			m_lastReport = std::chrono::steady_clock::now();
+		}
+		if(m_options.fGap > 0 && gap <= m_options.fGap) {
+			if(SANITY_PRINT || m_options.fGapReport > 0)
+				report_gap(open.bound);
+			RequestStop();
+			break;
+		}
 
-					// Can we prune this branch?
-					if(upperBound < fGlobalProbSuccess) {
-						// We won't find a better solution by branching here
-						keepBranch = false;
-						nPruningCount++;
-					}
+		// Back up to where the two paths split and replay the rest (see run_subtree())
+		unsigned int common = 0;
+		while(common < current.size() && common < open.path.size() && current.at(common) == open.path.at(common)) {
+			common++;
+		}
+		while(ctx.engine.Depth() > (int)common) {
+			ctx.engine.Pop();
+		}
+		for(unsigned int k = common; k < open.path.size(); k++) {
+			ctx.engine.Push(open.path.at(k));
+			if((int)k + 1 < input->getN()) {
+				matching_exists(ctx, input, k, open.path.at(k));
+			}
+		}
+		current.swap(open.path);
 
-					// Memory cleanup
-					for(int i = 0; i < input->getN(); i++) {
-						delete[] xp_ij[i];
-					}
-					delete[] xp_ij;
-				}
+		ctx.engine.Run(ctx);
+		if(Stopped()) {
+			break;
+		}
+	}
 
-				// Pruning by solution existence
-				int ratio = std::ceil(input->getN()/double(2.0)) + 1;
-				if(i > 0 && i <= ratio) {
-					if(keepBranch) {
-						// We only consider the set of unassigned agents (we just assigned i)
-						int next_to_assign = i+1;
-						int agents = input->getN() - next_to_assign;
-
-						// Are there still any agents left un-assigned? (conversely, was i the last agent..?)
-						if(agents > 0) {
-							/*
-							 * Treat agents that are not yet assigned as bijection matching problem
-							 *
-							 * costs
-							 *    1.1 1.2 1.x 2.1 2.2 2.3 2.x :tasks
-							 * 1  b11 b11 b11 b12 b12
-							 * 2  ...
-							 * 3
-							 * 4
-							 * 5
-							 * 6
-							 * 7'  1   1   0
-							 * :agents
-							 *
-							 * b_ij = 1 if i-can-do-j, 0 otherwise
-							 */
-
-							// Make a local copy of d_j
-							std::vector<int> local_d_j;
-							for(int local_j = 0; local_j < input->getM(); local_j++) {
-								local_d_j.push_back(input->get_d_j(local_j));
-							}
-
-							// Determine how many tasks STILL require agents
-							for(int local_i = 0; local_i < input->getN()-agents; local_i++) {
-								// Determine which task this agent was assigned to
-								for(int local_j = 0; local_j < input->getM(); local_j++) {
-									int agent_i = agentMap.at(local_i).agent_i;
-									if(x_ij[agent_i][local_j]) {
-										local_d_j.at(local_j) = std::max(0, local_d_j.at(local_j) - 1);
-									}
-								}
-							}
-
-							// Determine a_r, the number of required agents
-							int a_r = 0;
-							for(int local_j = 0; local_j < input->getM(); local_j++) {
-								a_r += local_d_j.at(local_j);
-							}
-
-							// Do we have enough agents...?
-							if(a_r <= agents) {
-								// Determine a_f, the number of floating agents
-								int a_f = agents - a_r;
-								// Determine np, the number of participants for balanced matching
-								int np = a_r + input->getM()*a_f;
-
-								if(DEBUG_MASP_BNM) {
-									printf("i=%d, n=%d, m=%d, a_r=%d, a_f=%d, np=%d\nTask Row:\n", i, agents, input->getM(), a_r, a_f, np);
-									for(int local_j = 0; local_j < input->getM(); local_j++) {
-										for(int i = 0; i < local_d_j.at(local_j); i++) {
-											printf(" %d.%d", local_j, i);
-										}
-										for(int i = 0; i < a_f; i++) {
-											printf(" %d.x", local_j);
-										}
-									}
-									printf("\n");
-								}
-
-								// Create a cost map
-								std::vector<std::vector<double> > costMatrix;
-								for(int local_i = 0; local_i < np; local_i ++) {
-									std::vector<double> temp;
-
-									// Is this a real agent?
-									int agentI = get_agent(local_i, agents);
-									if(agentI >= 0) {
-										// Real agent, check each task
-										for(int local_j = 0; local_j < np; local_j++) {
-											// Get the task index
-											int taskJ = get_task(local_j, input->getM(), a_f, local_d_j);
-											// Which actual agent are we dealing with..?
-											int agent_i = agentMap.at(next_to_assign+agentI).agent_i;
-											// Can i do j?
-											if(input->iCanDoj(agent_i, taskJ)) {
-												temp.push_back(0);
-											}
-											else {
-												// i can't do j... assign 1
-												temp.push_back(1);
-											}
-										}
-									}
-									else {
-										// Phantom agent.. assign 1 for non-floating task and 0 for floating tasks
-										for(int local_j = 0; local_j < np; local_j++) {
-											if(floating_task(local_j, input->getM(), a_f, local_d_j)) {
-												// Phantom agents prefer floating tasks
-												temp.push_back(0);
-											}
-											else {
-												// Phantoms do not prefer real tasks
-												temp.push_back(1);
-											}
-										}
-									}
-									costMatrix.push_back(temp);
-								}
-
-								// Sanity print
-								if(DEBUG_MASP_BNM) {
-	//								printf("Cost map:\n");
-									for(int i = 0; i < np; i++) {
-										for(int j = 0; j < np; j ++) {
-											printf("   %.0f", costMatrix.at(i).at(j));
-										}
-										puts("");
-									}
-								}
-
-								vector<int> assignment;
-								mHungAlgo.Solve(costMatrix, assignment);
-
-								// Sanity print
-								if(DEBUG_MASP_BNM) {
-									printf("Matchings:\n");
-									for(long unsigned int i = 0; i < assignment.size(); i++) {
-										printf(" %ld:%d -- %f\n", i, assignment.at(i), costMatrix.at(i).at(assignment.at(i)));
-									}
-								}
-
-								// What is the sum of the assignments?
-								double total_cost = 0.0;
-								for(int i = 0; i < np; i ++) {
-									total_cost += costMatrix.at(i).at(assignment.at(i));
-								}
-
-								// If the cost isn't 0.. then there does not exist a valid assignment
-								if(!isZero(total_cost)) {
-									keepBranch = false;
-//									fprintf(stderr, "Cutting branch using mathcing: i = %d, n  = %d, m = %d\n", i, input->getN(), input->getM());
-
-									// Sanity print
-									if(DEBUG_MASP_BNM) {
-										printf("No valid matching exists here:\nd_j:\n");
-										for(int j = 0; j < input->getM(); j++) {
-											printf("%d ", input->get_d_j(j));
-										}
-										puts("");
-										for(int i = 0; i < input->getN(); i++) {
-											for(int j = 0; j < input->getM(); j++) {
-												printf("%d ", x_ij[i][j]);
-											}
-										}
-										printf("\nAssignment cost: %f\n-- Prune by matching --\n", total_cost);
-									}
-								}
-								else {
-									// Sanity print
-									if(DEBUG_MASP_BNM) {
-										printf("-- Explore this branch --\n");
-									}
-								}
-							}
-							else {
-								// There aren't enough vacant agents to fill all requirements..
-								keepBranch = false;
-
-								// Sanity print
-								if(DEBUG_MASP_BNM) {
-									printf("Not enough agents here:\nd_j:\n");
-									for(int j = 0; j < input->getM(); j++) {
-										printf("%d ", input->get_d_j(j));
-									}
-									printf("\nNumber not assigned: %d, number still needed: %d\n-- Prune by requirements --\n", agents, a_r);
-								}
-							}
-						}
-					}
-				}
+	// Back to the root
+	while(ctx.engine.Depth() > 0) {
+		ctx.engine.Pop();
+	}
 
-				// Should we recurse on this branch?
-				if(keepBranch) {
-					// Increment i and recurse
-					assign_next(input, next_i, x_ij, I_crnt, agentMap);
-				}
+	if(m_options.fGapReport > 0 && !Stopped()) {
+		// Search finished, the bound is the incumbent
+		report_gap(fGlobalProbSuccess);
+	}
+	m_frontier = std::priority_queue<BnMOpen_t>();
+	m_nFrontierBytes = 0;
+}
 
-				// Reset i/j combo
-				x_ij[agentMap.at(i).agent_i][j] = false;
-			}
-		}
+// Prints the bound, incumbent and gap of the search with the number of open nodes
+void MASP_BranchAndMatch::report_gap(double bound) {
+	double Z = fGlobalProbSuccess;
+	double gap = (bound > 0) ? (bound - Z)/bound : 0;
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+	printf("[bnm] %.2fs bound = %f, incumbent = %f, gap = %f, open nodes = %zu (%.1f MB)\n",
+			elapsed, bound, Z, gap, m_frontier.size(), m_nFrontierBytes/(1024.0*1024.0));
+}
+
+/*
+ * Reads the --checkpoint file into m_checkpoint when resuming. Returns false if there is
+ * nothing to resume, fails hard if the checkpoint belongs to another search.
+ */
+bool MASP_BranchAndMatch::load_checkpoint(MASPInput* input) {
+	FILE* file = fopen(m_options.sCheckpoint.c_str(), "rb");
+	if(file == NULL) {
+		// No checkpoint yet, start from scratch
+		return false;
+	}
+	fclose(file);
+
+	if(!m_checkpoint.Read(m_options.sCheckpoint)) {
+		fprintf(stderr, "[ERROR][MASP_BranchAndMatch::load_checkpoint] : \"%s\" is not a complete checkpoint of this version\n", m_options.sCheckpoint.c_str());
+		exit(1);
+	}
+	if(m_checkpoint.nInputHash != Checkpoint::InputHash(input) || m_checkpoint.nN != input->getN() || m_checkpoint.nM != input->getM()
+			|| (int)m_checkpoint.vIncumbent.size() != input->getN()) {
+		fprintf(stderr, "[ERROR][MASP_BranchAndMatch::load_checkpoint] : Checkpoint \"%s\" was saved for another input\n", m_options.sCheckpoint.c_str());
+		exit(1);
 	}
+
+	return true;
 }
 
-// Determine if this is a valid solution
-bool MASP_BranchAndMatch::valid_solution(MASPInput* input, bool** x_ij) {
-	// Count the number of agents assigned to each task
-	for(int j = 0; j < input->getM(); j++) {
-		int agent_count = 0;
-		// Cycle through all agents
-		for(int i = 0; i < input->getN(); i++) {
-			if(x_ij[i][j]) {
-				agent_count++;
+// Saves where ctx is (called from on_node()), or that the search is done, with the incumbent and counters
+void MASP_BranchAndMatch::save_checkpoint(BnMContext_t& ctx, bool done) {
+	MASPInput* input = ctx.engine.Input();
+
+	m_checkpoint.bDone = done;
+	m_checkpoint.fIncumbent = fGlobalProbSuccess;
+	m_checkpoint.vIncumbent.assign(input->getN(), -1);
+	for(int i = 0; i < input->getN(); i++) {
+		for(int j = 0; j < input->getM(); j++) {
+			if(bGlobalX_ij[i][j]) {
+				m_checkpoint.vIncumbent.at(i) = j;
 			}
 		}
+	}
+	m_checkpoint.stats = ctx.stats;
+	m_checkpoint.stats.nPMFCalls += ctx.poissonB.Calls();
+	m_checkpoint.stats.nForced += ctx.engine.Forced();
+	m_checkpoint.stats.nPrunePropagation += ctx.engine.Failed();
+	if(done) {
+		m_checkpoint.vPath.clear();
+		m_checkpoint.vNext.clear();
+	}
+	else {
+		ctx.engine.Save(m_checkpoint.vPath, m_checkpoint.vNext);
+	}
 
-		// Check if we assigned enough agents to this task
-		if(agent_count < input->get_d_j(j)) {
-			// Not enough agents assigned to this task
-			return false;
-		}
+	// Keep searching without it, the last good checkpoint is still on disk
+	if(!m_checkpoint.Write(m_options.sCheckpoint)) {
+		fprintf(stderr, "[ERROR][MASP_BranchAndMatch::save_checkpoint] : Could not write checkpoint \"%s\"\n", m_options.sCheckpoint.c_str());
 	}
+}
 
-	// If we make it this far, all tasks must have enough agents
-	return true;
+/*
+ * Should the child at depth next_i be handed to the pool instead of searched right away?
+ * Every node down to the split depth is a task. Below it, a few more levels are handed out
+ * while some thread has run out of work.
+ */
+bool MASP_BranchAndMatch::spawn_child(int next_i) {
+	if(next_i >= (int)m_vvCanDo.size()) {
+		return false;
+	}
+	return next_i <= m_nSplitDepth || (next_i <= m_nSplitDepth + BNM_SPLIT_EXTRA && m_pool.Idle() > 0);
 }
 
 // Counts the number of recursive states required to iterate through (just FYI)
@@ -583,61 +710,165 @@ long int MASP_BranchAndMatch::countRecursiveStates(std::vector<BnMAgent_t>& agen
 
 
 
-// Takes balanced matching index and converts it into the corresponding agent's index.
-// Returns -1 if this is a phantom
-int MASP_BranchAndMatch::get_agent(int i, int N) {
-	if(i < N) {
-		return i;
+/*
+ * Determines if the unassigned agents can still be matched so that every task gets its
+ * remaining demand, given that the agent at depth i was just assigned to task. Agents left
+ * over can go to any task they can do, so this is a maximum b-matching of agents to
+ * remaining demand (Hopcroft-Karp). Warm-starts from the parent's matching in
+ * ctx.vvMatching[i], which differs by one agent and one unit of demand, and stores the
+ * result in ctx.vvMatching[i+1] for the children.
+ */
+bool MASP_BranchAndMatch::matching_exists(BnMContext_t& ctx, MASPInput* input, int i, int task) {
+	int N = input->getN();
+	int M = input->getM();
+
+	// Remaining demand after agent i took task
+	std::vector<int>& demand = ctx.vvDemand.at(i+1);
+	demand = ctx.vvDemand.at(i);
+	bool demandDropped = demand.at(task) > 0;
+	if(demandDropped) {
+		demand.at(task)--;
 	}
 
-	// This is a phantom agent
-	return -1;
-}
+	// Start from the parent's matching, the agent at depth i is no longer free to match
+	std::vector<int>& match = ctx.vvMatching.at(i+1);
+	match = ctx.vvMatching.at(i);
+	match.at(ctx.engine.Agent(i)) = -1;
 
-// Takes balanced matching index and converts it into the corresponding task's index
-int MASP_BranchAndMatch::get_task(int bal_j, int M, int a_f, std::vector<int>& d_j) {
-	int run_j = 0;
+	// Rebuild the load on each task
+	ctx.vLoad.assign(M, 0);
 	for(int j = 0; j < M; j++) {
-		for(int i = 0; i < d_j.at(j); i++) {
-			if(bal_j == run_j) {
-				return j;
+		ctx.vvTaskAgents.at(j).clear();
+	}
+	ctx.vFree.clear();
+	for(int k = 0; k < N; k++) {
+		if(ctx.engine.Task(k) < 0) {
+			ctx.vFree.push_back(k);
+		}
+	}
+	for(int k : ctx.vFree) {
+		// Every left-over agent needs something it can do
+		if(m_vvCanDo.at(k).empty()) {
+			return false;
+		}
+		int j = match.at(k);
+		if(j >= 0) {
+			if(demandDropped && j == task && ctx.vLoad.at(j) >= demand.at(j)) {
+				// Task lost a unit of demand, free this agent
+				match.at(k) = -1;
+			}
+			else {
+				ctx.vLoad.at(j)++;
+				ctx.vvTaskAgents.at(j).push_back(k);
 			}
-			run_j++;
 		}
-		for(int i = 0; i < a_f; i++) {
-			if(bal_j == run_j) {
-				return j;
+	}
+
+	// Augment until the matching is maximum
+	int required = 0;
+	int matched = 0;
+	for(int j = 0; j < M; j++) {
+		required += demand.at(j);
+		matched += ctx.vLoad.at(j);
+	}
+	while(matched < required && hk_layers(ctx, demand, match)) {
+		for(unsigned int f = 0; f < ctx.vFree.size() && matched < required; f++) {
+			int k = ctx.vFree.at(f);
+			if(match.at(k) < 0 && hk_augment(ctx, k, demand, match)) {
+				matched++;
 			}
-			run_j++;
 		}
 	}
 
-	// If you made it here... something went wrong -> hard fail!
-	fprintf(stderr, "[MASP_BalMatch::get_task] : Could not find mapping from bal_j to task_j, bal_j = %d\n", bal_j);
-	exit(1);
+	if(DEBUG_MASP_BNM)
+		printf("Matching at depth %d: %d of %d demand covered\n", i, matched, required);
+
+	return matched == required;
 }
 
-// Determines if this is a floating task
-bool MASP_BranchAndMatch::floating_task(int bal_j, int M, int a_f, std::vector<int>& d_j) {
-	int run_j = 0;
-	for(int j = 0; j < M; j++) {
-		for(int i = 0; i < d_j.at(j); i++) {
-			if(bal_j == run_j) {
-				return false;
+// Hopcroft-Karp phase: layers the unassigned agents by alternating BFS from the unmatched ones. Returns true if a task with spare demand is reachable
+bool MASP_BranchAndMatch::hk_layers(BnMContext_t& ctx, const std::vector<int>& demand, const std::vector<int>& match) {
+	ctx.vLayer.assign(match.size(), -1);
+	ctx.vQueue.clear();
+	for(int k : ctx.vFree) {
+		if(match.at(k) < 0) {
+			ctx.vLayer.at(k) = 0;
+			ctx.vQueue.push_back(k);
+		}
+	}
+
+	bool found = false;
+	for(unsigned int q = 0; q < ctx.vQueue.size(); q++) {
+		int k = ctx.vQueue.at(q);
+		for(int j : m_vvCanDo.at(k)) {
+			if(ctx.vLoad.at(j) < demand.at(j)) {
+				found = true;
+			}
+			else if(!found) {
+				// Walk back through the agents holding j
+				for(int other : ctx.vvTaskAgents.at(j)) {
+					if(ctx.vLayer.at(other) < 0) {
+						ctx.vLayer.at(other) = ctx.vLayer.at(k) + 1;
+						ctx.vQueue.push_back(other);
+					}
+				}
 			}
-			run_j++;
 		}
-		for(int i = 0; i < a_f; i++) {
-			if(bal_j == run_j) {
-				return true;
+	}
+
+	return found;
+}
+
+// Hopcroft-Karp augment: finds a layered alternating path from free agent k to spare demand and flips it
+bool MASP_BranchAndMatch::hk_augment(BnMContext_t& ctx, int k, const std::vector<int>& demand, std::vector<int>& match) {
+	for(int j : m_vvCanDo.at(k)) {
+		if(ctx.vLoad.at(j) < demand.at(j)) {
+			// Spare demand, take it
+			if(match.at(k) >= 0) {
+				removeTaskAgent(ctx, match.at(k), k);
+			}
+			match.at(k) = j;
+			ctx.vLoad.at(j)++;
+			ctx.vvTaskAgents.at(j).push_back(k);
+			return true;
+		}
+	}
+	for(int j : m_vvCanDo.at(k)) {
+		for(unsigned int a = 0; a < ctx.vvTaskAgents.at(j).size(); a++) {
+			int other = ctx.vvTaskAgents.at(j).at(a);
+			if(ctx.vLayer.at(other) == ctx.vLayer.at(k) + 1) {
+				if(hk_augment(ctx, other, demand, match)) {
+					// other moved on, k takes its place on j
+					ctx.vvTaskAgents.at(j).push_back(k);
+					ctx.vLoad.at(j)++;
+					if(match.at(k) >= 0) {
+						removeTaskAgent(ctx, match.at(k), k);
+					}
+					match.at(k) = j;
+					return true;
+				}
 			}
-			run_j++;
 		}
 	}
 
-	// If you made it here... something went wrong -> hard fail!
-	fprintf(stderr, "[MASP_BalMatch::floating_task] : Could not find mapping from bal_j to task_j, bal_j = %d\n", bal_j);
-	exit(1);
+	// Dead end, don't search from k again this phase
+	ctx.vLayer.at(k) = -1;
+	return false;
 }
 
+// Takes agent k off task j in the Hopcroft-Karp workspace
+void MASP_BranchAndMatch::removeTaskAgent(BnMContext_t& ctx, int j, int k) {
+	std::vector<int>& taskAgents = ctx.vvTaskAgents.at(j);
+	for(unsigned int a = 0; a < taskAgents.size(); a++) {
+		if(taskAgents.at(a) == k) {
+			taskAgents.at(a) = taskAgents.back();
+			taskAgents.pop_back();
+			ctx.vLoad.at(j)--;
+			return;
+		}
+	}
 
+	// If you made it here... something went wrong -> hard fail!
+	fprintf(stderr, "[MASP_BranchAndMatch::removeTaskAgent] : Agent %d is not on task %d\n", k, j);
+	exit(1);
+}
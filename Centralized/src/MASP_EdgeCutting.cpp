@@ -1,4 +1,7 @@
 #include "MASP_EdgeCutting.h"
+#include "SolverRegistry.h"
+
+REGISTER_SOLVER(e_Algo_MASP_EDGCUT, "edge-cut", MASP_EdgeCutting);
 
 
 MASP_EdgeCutting::MASP_EdgeCutting() {
@@ -8,6 +11,8 @@ MASP_EdgeCutting::MASP_EdgeCutting() {
 
 
 void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
+	m_PoissonB.ResetCalls();
+
 	// Create an initial solution using theoretical upper-bound logic
 	bool** x_ij = new bool*[input->getN()];
 	for(int i = 0; i < input->getN(); i++) {
@@ -72,7 +77,7 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 
 	// For fun, let's determine the probability that each task is complete
 	double upperBound = 1;
-	for(int j = 0; j < input->getM(); j++) {
+	for(int j = 0; j < input->getM() && !Stopped(); j++) {
 		double prob_j = 0;
 		// Get the number of agents/probabilities of completion for this task
 		std::vector<double> p_values;
@@ -83,7 +88,8 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 				p_values.push_back(input->get_p_ij(i, j));
 			}
 		}
-		for(int k = input->get_d_j(j); k <= agentsAssignedToTask; k++) {
+		// Each PMF is a full Poisson binomial, so read the clock every time
+		for(int k = input->get_d_j(j); k <= agentsAssignedToTask && !DeadlinePassed(); k++) {
 			// Find probability that exactly k agents complete task j
 			prob_j += m_PoissonB.PMF(k, agentsAssignedToTask, p_values);
 		}
@@ -91,13 +97,13 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 	}
 
 	// Sanity check...
-	if(!floatEquality(upperBound, input->UpperBound())) {
+	if(!Stopped() && !floatEquality(upperBound, input->UpperBound())) {
 		// Not what we expected... this should be the same logic
 		fprintf(stderr," [ERROR] : MASP_EdgeCutting::Solve : Calculated upper-bound = %f != %f = input upper-bound\n", upperBound, input->UpperBound());
 	}
 
-	// While we still don't have a consistent solution...
-	while(!validSolution(input, x_ij)) {
+	// While we still don't have a consistent solution... (each pass is long, so read the clock every time)
+	while(!validSolution(input, x_ij) && !DeadlinePassed()) {
 		// Sanity print
 		if(DEBUG_MASP_EC)
 			printf("Searching for the best task\n");
@@ -105,7 +111,7 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 		// Pick best-performing task j' with more than d_j' agents and at least one agent can go to another task
 		int bestJ = -1;
 		double bestSuccess = 0;
-		for(int j = 0; j < input->getM(); j++) {
+		for(int j = 0; j < input->getM() && !DeadlinePassed(); j++) {
 			// Determine the probability that j is completed
 			std::vector<double> p_values;
 			int agentCount = 0;
@@ -140,6 +146,10 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 			}
 		}
 
+		if(Stopped()) {
+			// Out of time mid-pass
+			break;
+		}
 		if(bestJ == -1) {
 			// We should have found an agent... hard fail
 			fprintf(stderr, " [ERROR] : MASP_EdgeCutting::Solve : best task = -1\n");
@@ -156,7 +166,7 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 		// Pick least-helpful agent i' assigned to j' that is also assigned to another task j''
 		int agent_to_boot = -1;
 		double agent_contribution = 1.01;
-		for(int i = 0; i < input->getN(); i++) {
+		for(int i = 0; i < input->getN() && !DeadlinePassed(); i++) {
 			if(x_ij[i][bestJ]) {
 				// Sanity print
 				if(DEBUG_MASP_EC)
@@ -203,6 +213,9 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 		if(DEBUG_MASP_EC)
 			printf(" found agent %d, d P_s = %f\n", agent_to_boot, agent_contribution);
 
+		if(Stopped()) {
+			break;
+		}
 		if(agent_to_boot == -1) {
 			// We should have found an agent... hard fail
 			fprintf(stderr, " [ERROR] : MASP_EdgeCutting::Solve : Agent to boot = -1\n");
@@ -224,6 +237,21 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 		}
 	}
 
+	if(Stopped()) {
+		// Out of time, agents still on several tasks keep the one they are best at
+		for(int i = 0; i < input->getN(); i++) {
+			int bestJ = -1;
+			for(int j = 0; j < input->getM(); j++) {
+				if(x_ij[i][j] && (bestJ < 0 || input->get_p_ij(i, j) > input->get_p_ij(i, bestJ))) {
+					bestJ = j;
+				}
+			}
+			for(int j = 0; j < input->getM(); j++) {
+				x_ij[i][j] = (j == bestJ);
+			}
+		}
+	}
+
 	// Verify that we found a valid solution...
 
 	// Assign agents to task in solution
@@ -236,6 +264,9 @@ void MASP_EdgeCutting::Solve(MASPInput* input, I_solution* I_crnt) {
 		}
 	}
 
+	// Record P_s evaluations
+	m_stats.nPMFCalls += m_PoissonB.Calls();
+
 	// Memory cleanup
 	for(int i = 0; i < input->getN(); i++) {
 		delete[] x_ij[i];
@@ -1,4 +1,7 @@
 #include "MASP_GradientSearch.h"
+#include "SolverRegistry.h"
+
+REGISTER_SOLVER(e_Algo_MASP_GRADSEARCH, "grad-search", MASP_GradientSearch);
 
 
 MASP_GradientSearch::MASP_GradientSearch() {
@@ -22,10 +25,13 @@ void MASP_GradientSearch::Solve(MASPInput* input, I_solution* I_crnt) {
 	}
 	double currentZ = 0;
 
-	// While we are still making updates..
+	// Cache per-task P_s so that candidate moves only re-evaluate two tasks
+	InitDeltaCache(input, x_ij);
+
+	// While we are still making updates.. (best-improvement search only needs one pass to place everyone)
 	iterationCount = 0;
 	int iterationsWOChange = 0;
-	while(iterationsWOChange < input->getN()) {
+	while(iterationsWOChange < input->getN() && !(m_options.bBestImprovement && iterationCount >= input->getN()) && !StopRequested()) {
 		bool madeChange = true;
 		int index = iterationCount%input->getN();
 
@@ -71,18 +77,14 @@ void MASP_GradientSearch::Solve(MASPInput* input, I_solution* I_crnt) {
 				if(DEBUG_MASP_GS)
 					printf(" Agent %d wants task %d, with %f\n", index, std::get<1>(n), std::get<0>(n));
 
-				// How man agents are already assigned to j?
-				int assigedToJ = 0;
-				for(int i = 0; i < input->getN(); i++) {
-					if(x_ij[i][j]) {
-						assigedToJ++;
-					}
-				}
+				// How man agents are already assigned to j? (the cache still counts this agent on currentJ)
+				int assigedToJ = CachedNj(j) - ((j == currentJ) ? 1 : 0);
 
 				// If there is still room for this agent...
 				if(assigedToJ < input->get_d_j(j)) {
 					// Assign this agent to j
 					x_ij[index][j] = true;
+					ApplyMove(input, index, currentJ, j);
 					joinedTask = true;
 
 					// Debug print
@@ -129,6 +131,7 @@ void MASP_GradientSearch::Solve(MASPInput* input, I_solution* I_crnt) {
 
 				// Assign i to its favorite task
 				x_ij[index][bestJ] = true;
+				ApplyMove(input, index, currentJ, bestJ);
 
 				// Debug print
 				if(DEBUG_MASP_GS) {
@@ -141,21 +144,18 @@ void MASP_GradientSearch::Solve(MASPInput* input, I_solution* I_crnt) {
 				// For each task...
 				for(int j = 0; j < input->getM(); j++) {
 					if(input->iCanDoj(index, j)) {
-						// Try to assign this agent to the task
-						x_ij[index][j] = true;
-						// Check if this improved the performance
-						double Z = BenchmarkCF(input, x_ij);
+						// Check if moving here improves the performance (only re-evaluates currentJ and j)
+						double Z = CachedZ() + deltaZ(input, index, currentJ, j);
 						if(Z > bestZ) {
 							// Found a better spot
 							bestZ = Z;
 							bestJ = j;
 						}
-						// Reset
-						x_ij[index][j] = false;
 					}
 				}
 				// Assign the task that had the greatest impact
 				x_ij[index][bestJ] = true;
+				ApplyMove(input, index, currentJ, bestJ);
 
 				// Debug print
 				if(DEBUG_MASP_GS) {
@@ -183,11 +183,17 @@ void MASP_GradientSearch::Solve(MASPInput* input, I_solution* I_crnt) {
 			iterationsWOChange++;
 		}
 
-		currentZ = BenchmarkCF(input, x_ij);
+		currentZ = CachedZ();
 		if(SANITY_PRINT)
 			printf("  Round %d, Z = %f\n", iterationCount, currentZ);
 	}
 
+	if(m_options.bBestImprovement) {
+		// Finish by repeatedly taking the best single-agent move
+		iterationCount += BestImprovementSearch(input, x_ij);
+		currentZ = CachedZ();
+	}
+
 	if(SANITY_PRINT) {
 		printf("--------------------------------------------------------\n");
 		printf("* Final Z = %f\n\n", currentZ);
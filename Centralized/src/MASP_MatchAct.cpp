@@ -1,10 +1,12 @@
 #include "MASP_MatchAct.h"
+#include "SolverRegistry.h"
+
+REGISTER_SOLVER(e_Algo_MASP_MTCHACT, "match-act", MASP_MatchAct);
 
 
 MASP_MatchAct::MASP_MatchAct() {
 	if(SANITY_PRINT)
 		printf("Hello from MASP_MatchAct Solver!\n");
-	srand (time(NULL));
 }
 
 
@@ -25,14 +27,17 @@ void MASP_MatchAct::Solve(MASPInput* input, I_solution* I_crnt) {
 	 * The costs are the probability that an agent fails to
 	 * complete a task q_ij = (1-pij)
 	 */
+	BalancedModel model;
+	model.Build(input, e_Layout_Square);
+
 	// Create cost matrix (NxN where cost[i][j] is the prob. that agent i fails at task j)
 	std::vector<std::vector<double> > costMatrix;
 	for(int i = 0; i < input->getN(); i ++) {
 		std::vector<double> temp;
 		for(int j = 0; j < input->getN(); j++) {
-			if(get_task(j, input) >= 0) {
+			if(model.Task(j) >= 0) {
 				// Regular task.. push probability of failure
-				temp.push_back(1-input->get_p_ij(i, get_task(j, input)));
+				temp.push_back(1-input->get_p_ij(i, model.Task(j)));
 			}
 			else {
 				// Floating task.. push probability of 1
@@ -47,7 +52,7 @@ void MASP_MatchAct::Solve(MASPInput* input, I_solution* I_crnt) {
 	if(DEBUG_MASP_MCHAC) {
 		printf("Cost Matrix:\n   ");
 		for(int j = 0; j < input->getN(); j++) {
-			printf("     %d", get_task(j, input));
+			printf("     %d", model.Task(j));
 		}
 		printf("\n");
 		for(long unsigned int i = 0; i < costMatrix.size(); i++) {
@@ -61,7 +66,7 @@ void MASP_MatchAct::Solve(MASPInput* input, I_solution* I_crnt) {
 
 	// Run Hungarian algorithm
 	vector<int> assignmentArray;
-	mHungAlgo.Solve(costMatrix, assignmentArray);
+	solveAssignment(costMatrix, assignmentArray);
 
 	std::vector<std::vector<int>> combos;
 	for(int j = 0; j < input->getM(); j++) {
@@ -72,8 +77,8 @@ void MASP_MatchAct::Solve(MASPInput* input, I_solution* I_crnt) {
 
 	// Extract agent-task assignments
 	for(int i = 0; i < input->getN(); i++) {
-		if(get_task(assignmentArray.at(i), input) >= 0) {
-			combos.at(get_task(assignmentArray.at(i), input)).push_back(i);
+		if(model.Task(assignmentArray.at(i)) >= 0) {
+			combos.at(model.Task(assignmentArray.at(i))).push_back(i);
 		}
 		else {
 			// This agent was assigned to a dummy task...
@@ -118,8 +123,8 @@ void MASP_MatchAct::Solve(MASPInput* input, I_solution* I_crnt) {
 		printf("]\n");
 	}
 
-	// Run blind auction
-	while(!I_e.empty()) {
+	// Run blind auction (each bid runs M simulations, so read the clock every time)
+	while(!I_e.empty() && !DeadlinePassed()) {
 		int i = I_e.back();
 		I_e.pop_back();
 		// How much is each task willing to pay for this task?
@@ -155,6 +160,19 @@ void MASP_MatchAct::Solve(MASPInput* input, I_solution* I_crnt) {
 			printf(" %d has winning bid at %f\n", winning_j, highest_bid);
 	}
 
+	// Out of time, the agents left just join their favorite task
+	for(int i : I_e) {
+		int bestJ = -1;
+		for(int j = 0; j < input->getM(); j++) {
+			if(input->iCanDoj(i, j) && (bestJ < 0 || input->get_p_ij(i, j) > input->get_p_ij(i, bestJ))) {
+				bestJ = j;
+			}
+		}
+		if(bestJ >= 0) {
+			combos.at(bestJ).push_back(i);
+		}
+	}
+
 	// Extract solution from I_a and store it in x_ij
 	for(int j = 0; j < input->getM(); j++) {
 		for(auto i : combos.at(j)) {
@@ -173,34 +191,6 @@ void MASP_MatchAct::Solve(MASPInput* input, I_solution* I_crnt) {
 }
 
 
-/*
- * Takes cost matrix index and converts it into the corresponding task's index. This assumes
- * that the entries in the matrix are in order based on minimum required agents per task
- * (e.g. 1.1 1.2 2.1 2.2 .. x.1 x.2 ..). It will return -1 if the given index is past the
- * minimum number of agents required over tasks (in x range from example).
- */
-int MASP_MatchAct::get_task(int index, MASPInput* input) {
-	// Verify that we were given a valid input
-	if((index < 0) || (index >= input->getN())) {
-		// Something went wrong -> hard fail!
-		fprintf(stderr, "[MASP_MatchAct::get_task] : Bad index = %d\n", index);
-		exit(1);
-	}
-
-	// Run through each task
-	int run_j = 0;
-	for(int j = 0; j < input->getM();j++) {
-		for(int jj = 0; jj < input->get_d_j(j); jj++) {
-			if(index == run_j) {
-				return j;
-			}
-			run_j++;
-		}
-	}
-
-	return -1;
-}
-
 // Runs Monti Carlo Simulation to determine the probability that the agents in I_j complete task j
 double MASP_MatchAct::monteSim(MASPInput* input, std::vector<int>& I_j, int j, I_solution* I_curnt) {
 	double chance_of_success = 0;
@@ -1,4 +1,7 @@
 #include "MASP_MatchGS.h"
+#include "SolverRegistry.h"
+
+REGISTER_SOLVER(e_Algo_MASP_MTCHGS, "match-gs", MASP_MatchGS);
 
 
 MASP_MatchGS::MASP_MatchGS() {
@@ -25,12 +28,120 @@ void MASP_MatchGS::Solve(MASPInput* input, I_solution* I_crnt) {
 	 * The costs are the probability that an agent fails to
 	 * complete a task q_ij = (1-pij)
 	 */
-	// Create cost matrix (NxN where cost[i][j] is the prob. that agent i fails at task j)
-	std::vector<std::vector<double> > costMatrix;
+	BalancedModel model;
+	model.Build(input, e_Layout_Square);
+
+	vector<int> assignmentArray;
+	bool assigned = false;
+	if(m_options.nAssignment == e_Assign_Sparse) {
+		// Only hand the compatible agent/slot pairs to the sparse solver, no INF entries
+		std::vector<int> slotTask;
+		for(int j = 0; j < input->getN(); j++) {
+			slotTask.push_back(model.Task(j));
+		}
+		std::vector<SparseEdge_t> edges;
+		for(int i = 0; i < input->getN(); i++) {
+			for(int j = 0; j < input->getN(); j++) {
+				if(slotTask.at(j) < 0) {
+					// Floating task.. probability of 1
+					edges.push_back({i, j, 1});
+				}
+				else if(input->iCanDoj(i, slotTask.at(j))) {
+					// Regular task.. probability of failure
+					edges.push_back({i, j, 1-input->get_p_ij(i, slotTask.at(j))});
+				}
+			}
+		}
+		assigned = solveSparseAssignment(input->getN(), input->getN(), edges, assignmentArray);
+	}
+
+	if(!assigned) {
+		// Dense matrix, also the fallback when some agent can only be matched through an INF entry
+		std::vector<std::vector<double> > costMatrix;
+		buildCostMatrix(input, model, costMatrix);
+
+		// Sanity print...
+		if(DEBUG_MASP_MCHGS) {
+			printf("Cost Matrix:\n   ");
+			for(int j = 0; j < input->getN(); j++) {
+				printf("     %d", model.Task(j));
+			}
+			printf("\n");
+			for(long unsigned int i = 0; i < costMatrix.size(); i++) {
+				printf(" %ld: ", i);
+				for(long unsigned int j = 0; j < costMatrix.at(i).size(); j++) {
+					printf(" %.3f", costMatrix.at(i).at(j));
+				}
+				printf("\n");
+			}
+		}
+
+		// Run Hungarian algorithm
+		solveAssignment(costMatrix, assignmentArray);
+	}
+
+	// Create local solution
+	bool** x_ij = new bool*[input->getN()];
+	for(int i = 0; i < input->getN(); i++) {
+		x_ij[i] = new bool[input->getM()];
+	}
+
+	// Extract agent-task assignments
+	extract(input, model, assignmentArray, x_ij);
+
+	// Sanity print
+	if(DEBUG_MASP_MCHGS) {
+		printf("Solution after matching:\n");
+		for(int i = 0; i < input->getN(); i++) {
+			for(int j = 0; j < input->getM(); j++) {
+				printf(" %d", x_ij[i][j]);
+			}
+		}
+	}
+
+	iterationCount = 0;
+	double currentZ = descend(input, x_ij);
+
+	if(m_options.bRematch) {
+		// Try the matchings that keep one agent off its task
+		currentZ = rematch(input, model, x_ij, currentZ);
+	}
+
+	if(SANITY_PRINT) {
+		printf("--------------------------------------------------------\n");
+		printf("* Final Z = %f\n\n", currentZ);
+	}
+
+	// Save found solution
+	for(int i = 0; i < input->getN(); i++) {
+		for(int j = 0; j < input->getM(); j++) {
+			if(x_ij[i][j]) {
+				I_crnt->Update(input,i,j);
+			}
+		}
+	}
+
+	if(DEBUG_MASP_MCHGS)
+		I_crnt->PrintSolution();
+
+	// Free memory
+	for(int i = 0; i < input->getN(); i++) {
+		delete[] x_ij[i];
+	}
+
+	std::ofstream outfile("MatchGS.txt", std::ios::app);
+	// outfile << "Input file: " << input->input_fileName << " has the following results: " << I_crnt->BenchmarkClsdForm() << std::endl;
+	outfile << I_crnt->BenchmarkClsdForm() << std::endl;
+	delete[] x_ij;
+}
+
+// Fills costMatrix (NxN where cost[i][j] is the prob. that agent i fails at slot j)
+void MASP_MatchGS::buildCostMatrix(MASPInput* input, BalancedModel& model, std::vector<std::vector<double>>& costMatrix) {
+	costMatrix.clear();
 	for(int i = 0; i < input->getN(); i ++) {
 		std::vector<double> temp;
 		for(int j = 0; j < input->getN(); j++) {
-			int taskJ = get_task(j, input);
+			int taskJ = model.Task(j);
 			if(taskJ >= 0) {
 				if(input->iCanDoj(i, taskJ)) {
 					// Regular task.. push probability of failure
@@ -48,40 +159,15 @@ void MASP_MatchGS::Solve(MASPInput* input, I_solution* I_crnt) {
 		}
 		costMatrix.push_back(temp);
 	}
+}
 
-	// Sanity print...
-	if(DEBUG_MASP_MCHGS) {
-		printf("Cost Matrix:\n   ");
-		for(int j = 0; j < input->getN(); j++) {
-			printf("     %d", get_task(j, input));
-		}
-		printf("\n");
-		for(long unsigned int i = 0; i < costMatrix.size(); i++) {
-			printf(" %ld: ", i);
-			for(long unsigned int j = 0; j < costMatrix.at(i).size(); j++) {
-				printf(" %.3f", costMatrix.at(i).at(j));
-			}
-			printf("\n");
-		}
-	}
-
-	// Run Hungarian algorithm
-	vector<int> assignmentArray;
-	mHungAlgo.Solve(costMatrix, assignmentArray);
-
-	// Create local solution
-	bool** x_ij = new bool*[input->getN()];
+// Sets x_ij to the agent-task assignments of the slot matching assignment
+void MASP_MatchGS::extract(MASPInput* input, BalancedModel& model, const std::vector<int>& assignment, bool** x_ij) {
 	for(int i = 0; i < input->getN(); i++) {
-		x_ij[i] = new bool[input->getM()];
 		for(int j = 0; j < input->getM(); j++) {
 			x_ij[i][j] = false;
 		}
-	}
-	double currentZ = 0;
-
-	// Extract agent-task assignments
-	for(int i = 0; i < input->getN(); i++) {
-		int j = get_task(assignmentArray.at(i), input);
+		int j = model.Task(assignment.at(i));
 		if(j >= 0) {
 			x_ij[i][j] = true;
 		}
@@ -89,24 +175,21 @@ void MASP_MatchGS::Solve(MASPInput* input, I_solution* I_crnt) {
 			// This agent was assigned to a dummy task...
 		}
 	}
+}
 
-	// Sanity print
-	if(DEBUG_MASP_MCHGS) {
-		printf("Solution after matching:\n");
-		for(int i = 0; i < input->getN(); i++) {
-			for(int j = 0; j < input->getM(); j++) {
-				printf(" %d", x_ij[i][j]);
-			}
-		}
-	}
+// Runs the gradient search from x_ij until no agent wants to move, returns the final Z
+double MASP_MatchGS::descend(MASPInput* input, bool** x_ij) {
+	double currentZ = 0;
 
+	// Cache per-task P_s so that candidate moves only re-evaluate two tasks
+	InitDeltaCache(input, x_ij);
 
-	// While we are still making updates..
-	iterationCount = 0;
+	// While we are still making updates.. (best-improvement search only needs one pass to place everyone)
+	int iteration = 0;
 	int iterationsWOChange = 0;
-	while(iterationsWOChange < input->getN()) {
+	while(iterationsWOChange < input->getN() && !(m_options.bBestImprovement && iteration >= input->getN()) && !StopRequested()) {
 		bool madeChange = true;
-		int index = iterationCount%input->getN();
+		int index = iteration%input->getN();
 
 		// Debug print
 		if(DEBUG_MASP_MCHGS) {
@@ -142,6 +225,7 @@ void MASP_MatchGS::Solve(MASPInput* input, I_solution* I_crnt) {
 
 			// Assign i to its favorite task
 			x_ij[index][bestJ] = true;
+			ApplyMove(input, index, currentJ, bestJ);
 
 			// Debug print
 			if(DEBUG_MASP_MCHGS) {
@@ -154,21 +238,18 @@ void MASP_MatchGS::Solve(MASPInput* input, I_solution* I_crnt) {
 			// For each task...
 			for(int j = 0; j < input->getM(); j++) {
 				if(input->iCanDoj(index, j)) {
-					// Try to assign this agent to the task
-					x_ij[index][j] = true;
-					// Check if this improved the performance
-					double Z = BenchmarkCF(input, x_ij);
+					// Check if moving here improves the performance (only re-evaluates currentJ and j)
+					double Z = CachedZ() + deltaZ(input, index, currentJ, j);
 					if(Z > bestZ) {
 						// Found a better spot
 						bestZ = Z;
 						bestJ = j;
 					}
-					// Reset
-					x_ij[index][j] = false;
 				}
 			}
 			// Assign the task that had the greatest impact
 			x_ij[index][bestJ] = true;
+			ApplyMove(input, index, currentJ, bestJ);
 
 			// Debug print
 			if(DEBUG_MASP_MCHGS) {
@@ -187,6 +268,7 @@ void MASP_MatchGS::Solve(MASPInput* input, I_solution* I_crnt) {
 			}
 		}
 
+		iteration++;
 		iterationCount++;
 		if(madeChange) {
 			iterationsWOChange = 0;
@@ -195,64 +277,98 @@ void MASP_MatchGS::Solve(MASPInput* input, I_solution* I_crnt) {
 			iterationsWOChange++;
 		}
 
-		currentZ = BenchmarkCF(input, x_ij);
+		currentZ = CachedZ();
 		if(SANITY_PRINT)
 			printf("  Round %d, Z = %f\n", iterationCount, currentZ);
 	}
 
-	if(SANITY_PRINT) {
-		printf("--------------------------------------------------------\n");
-		printf("* Final Z = %f\n\n", currentZ);
+	if(m_options.bBestImprovement) {
+		// Finish by repeatedly taking the best single-agent move
+		iterationCount += BestImprovementSearch(input, x_ij);
+		currentZ = CachedZ();
 	}
 
-	// Save found solution
-	for(int i = 0; i < input->getN(); i++) {
-		for(int j = 0; j < input->getM(); j++) {
-			if(x_ij[i][j]) {
-				I_crnt->Update(input,i,j);
-			}
-		}
-	}
+	return currentZ;
+}
 
-	if(DEBUG_MASP_MCHGS)
-		I_crnt->PrintSolution();
+/*
+ * Re-matching neighbourhood. For each agent, the slots of its task in x_ij get an INF cost
+ * and the matching is repaired with one augmenting path of m_lap, then the gradient search
+ * runs from the new matching. x_ij is replaced whenever that beats Z, its current value.
+ * Returns the best Z found.
+ */
+double MASP_MatchGS::rematch(MASPInput* input, BalancedModel& model, bool** x_ij, double Z) {
+	int N = input->getN();
+	int M = input->getM();
 
-	// Free memory
-	for(int i = 0; i < input->getN(); i++) {
-		delete[] x_ij[i];
+	std::vector<std::vector<double> > costMatrix;
+	buildCostMatrix(input, model, costMatrix);
+	auto start = std::chrono::steady_clock::now();
+	m_lap.Solve(costMatrix);
+	auto stop = std::chrono::steady_clock::now();
+	m_stats.nHungarianCalls++;
+	m_stats.fAssignmentTime += std::chrono::duration<double>(stop - start).count();
+
+	bool** x_cand = new bool*[N];
+	for(int i = 0; i < N; i++) {
+		x_cand[i] = new bool[M];
 	}
+	std::vector<int> assignment(N);
 
-	std::ofstream outfile("MatchGS.txt", std::ios::app);
-	// outfile << "Input file: " << input->input_fileName << " has the following results: " << I_crnt->BenchmarkClsdForm() << std::endl;
-	outfile << I_crnt->BenchmarkClsdForm() << std::endl;
-	delete[] x_ij;
-}
+	for(int i = 0; i < N && !DeadlinePassed(); i++) {
+		int task = -1;
+		for(int j = 0; j < M; j++) {
+			if(x_ij[i][j]) {
+				task = j;
+			}
+		}
+		if(task < 0) {
+			continue;
+		}
+
+		// Keep agent i off its task
+		std::vector<double> row = costMatrix.at(i);
+		for(int s = 0; s < N; s++) {
+			if(model.Task(s) == task) {
+				row.at(s) = INF;
+			}
+		}
+		start = std::chrono::steady_clock::now();
+		double cost = m_lap.UpdateRow(i, row);
+		for(int k = 0; k < N; k++) {
+			assignment.at(k) = m_lap.Assignment(k);
+		}
+		// Back to the unconstrained matching for the next agent
+		m_lap.UpdateRow(i, costMatrix.at(i));
+		stop = std::chrono::steady_clock::now();
+		m_stats.nHungarianCalls += 2;
+		m_stats.fAssignmentTime += std::chrono::duration<double>(stop - start).count();
+
+		if(cost >= INF) {
+			// Agent i has nowhere else to go
+			continue;
+		}
 
+		extract(input, model, assignment, x_cand);
+		double candZ = descend(input, x_cand);
 
-/*
- * Takes cost matrix index and converts it into the corresponding task's index. This assumes
- * that the entries in the matrix are in order based on minimum required agents per task
- * (e.g. 1.1 1.2 2.1 2.2 .. x.1 x.2 ..). It will return -1 if the given index is past the
- * minimum number of agents required over tasks (in x range from example).
- */
-int MASP_MatchGS::get_task(int index, MASPInput* input) {
-	// Verify that we were given a valid input
-	if((index < 0) || (index >= input->getN())) {
-		// Something went wrong -> hard fail!
-		fprintf(stderr, "[MASP_MatchAct::get_task] : Bad index = %d\n", index);
-		exit(1);
-	}
+		if(DEBUG_MASP_MCHGS)
+			printf("Re-matched without agent %d on task %d: Z = %f\n", i, task, candZ);
 
-	// Run through each task
-	int run_j = 0;
-	for(int j = 0; j < input->getM();j++) {
-		for(int jj = 0; jj < input->get_d_j(j); jj++) {
-			if(index == run_j) {
-				return j;
+		if(candZ > Z) {
+			Z = candZ;
+			for(int k = 0; k < N; k++) {
+				for(int j = 0; j < M; j++) {
+					x_ij[k][j] = x_cand[k][j];
+				}
 			}
-			run_j++;
 		}
 	}
 
-	return -1;
+	for(int i = 0; i < N; i++) {
+		delete[] x_cand[i];
+	}
+	delete[] x_cand;
+
+	return Z;
 }
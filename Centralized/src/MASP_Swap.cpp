@@ -1,10 +1,12 @@
 #include "MASP_Swap.h"
+#include "SolverRegistry.h"
+
+REGISTER_SOLVER(e_Algo_MASP_SWAP, "swap", MASP_Swap);
 
 
 MASP_Swap::MASP_Swap() {
 	if(SANITY_PRINT)
 		printf("Hello from MASP_Swap Solver!\n");
-	srand (time(NULL));
 	a_r=0;
 	a_f=0;
 	np=0;
@@ -29,16 +31,13 @@ void MASP_Swap::Solve(MASPInput* input, I_solution* I_crnt) {
 	 * q_ij = (1-p_ij)
 	 */
 
-	// Determine a_r, the number of required agents
 	std::string input_file = input->input_fileName;	
-	a_r = 0;
-	for(int j = 0; j < input->getM(); j++) {
-		a_r += input->get_d_j(j);
-	}
-	// Determine a_f, the number of floating agents
-	a_f = input->getN() - a_r;
-	// Determine np, the number of participants for balanced matching
-	np = a_r + input->getM()*a_f;
+	// Determine a_r, a_f and np (the number of participants) from the slot tables
+	BalancedModel model;
+	model.Build(input, e_Layout_Balanced);
+	a_r = model.RequiredAgents();
+	a_f = model.FloatingAgents();
+	np = model.Size();
 	if(DEBUG_MASP_SWAP) {
 		printf("n=%d, m=%d, a_r=%d, a_f=%d, np=%d\nTask Row:\n", input->getN(), input->getM(), a_r, a_f, np);
 		for(int j = 0; j < input->getM();j++) {
@@ -52,66 +51,94 @@ void MASP_Swap::Solve(MASPInput* input, I_solution* I_crnt) {
 		printf("\n");
 	}
 
-	// Create a cost map
-	std::vector<std::vector<double> > costMatrix;
-	for(int i = 0; i < np; i ++) {
-		std::vector<double> temp;
-
-		// Is this a real agent?
-		int agentI = get_agent(i, input);
-		if(agentI >= 0) {
-			for(int j = 0; j < np; j++) {
-				int taskJ = get_task(j, input);
+	// Match agents to tasks as a transportation problem
+	std::vector<int> agentTask;
+	bool matched = false;
+	if(m_options.nMatching == e_Match_Flow) {
+		std::vector<double> cost(input->getN()*input->getM());
+		for(int i = 0; i < input->getN(); i++) {
+			for(int j = 0; j < input->getM(); j++) {
 				// Can i do j?
-				if(input->iCanDoj(agentI, taskJ)) {
-					temp.push_back(1-input->get_p_ij(agentI, taskJ));
+				if(input->iCanDoj(i, j)) {
+					cost.at(i*input->getM() + j) = 1-input->get_p_ij(i, j);
 				}
 				else {
 					// i can't do j... assign INF
-					temp.push_back(INF);
+					cost.at(i*input->getM() + j) = INF;
 				}
 			}
 		}
-		else {
-			// Phantom agent.. assign 1 for non-floating task and 0 for floating tasks
-			for(int j = 0; j < np; j++) {
-				if(floating_task(j, input)) {
-					// Phantom agents prefer floating tasks
-					temp.push_back(0);
+		matched = solveTransportation(input, cost, agentTask);
+	}
+
+	if(!matched) {
+		// Expanded assignment matrix, also the fallback when the flow finds no feasible assignment
+		// Create a cost map
+		std::vector<std::vector<double> > costMatrix;
+		for(int i = 0; i < np; i ++) {
+			std::vector<double> temp;
+
+			// Is this a real agent?
+			int agentI = model.Agent(i);
+			if(agentI >= 0) {
+				for(int j = 0; j < np; j++) {
+					int taskJ = model.Task(j);
+					// Can i do j?
+					if(input->iCanDoj(agentI, taskJ)) {
+						temp.push_back(1-input->get_p_ij(agentI, taskJ));
+					}
+					else {
+						// i can't do j... assign INF
+						temp.push_back(INF);
+					}
 				}
-				else {
-					// Phantoms do not prefer real tasks
-					temp.push_back(INF);
+			}
+			else {
+				// Phantom agent.. assign 1 for non-floating task and 0 for floating tasks
+				for(int j = 0; j < np; j++) {
+					if(model.Floating(j)) {
+						// Phantom agents prefer floating tasks
+						temp.push_back(0);
+					}
+					else {
+						// Phantoms do not prefer real tasks
+						temp.push_back(INF);
+					}
 				}
 			}
+			costMatrix.push_back(temp);
 		}
-		costMatrix.push_back(temp);
-	}
 
-	// Sanity print
-	if(DEBUG_MASP_SWAP) {
-		printf("Cost map:\n");
-		for(int j = 0; j < np; j ++) {
-			for(int i = 0; i < np; i++) {
-				printf(" %.2f", costMatrix.at(i).at(j));
+		// Sanity print
+		if(DEBUG_MASP_SWAP) {
+			printf("Cost map:\n");
+			for(int j = 0; j < np; j ++) {
+				for(int i = 0; i < np; i++) {
+					printf(" %.2f", costMatrix.at(i).at(j));
+				}
+				puts("");
 			}
-			puts("");
 		}
-	}
 
-	vector<int> assignment;
-	mHungAlgo.Solve(costMatrix,assignment);
+		vector<int> assignment;
+		solveAssignment(costMatrix, assignment);
 
-	// Sanity print
-	if(DEBUG_MASP_SWAP) {
-		printf("Matchings:\n");
-		for(long unsigned int i = 0; i < assignment.size(); i++) {
-			printf(" %ld:%d\n", i, assignment.at(i));
+		// Sanity print
+		if(DEBUG_MASP_SWAP) {
+			printf("Matchings:\n");
+			for(long unsigned int i = 0; i < assignment.size(); i++) {
+				printf(" %ld:%d\n", i, assignment.at(i));
+			}
+		}
+
+		agentTask.clear();
+		for(int i = 0; i < input->getN(); i++) {
+			agentTask.push_back(model.Task(assignment.at(i)));
 		}
 	}
 
 	for(int i = 0; i < input->getN(); i++) {
-		I_crnt->Update(input,i, get_task(assignment.at(i), input));
+		I_crnt->Update(input,i, agentTask.at(i));
 	}
 
 	if(DEBUG_MASP_SWAP){
@@ -149,12 +176,20 @@ void MASP_Swap::Solve(MASPInput* input, I_solution* I_crnt) {
 	four_swap(I_crnt, input, outputHolder);
 	benchmarks[3] = outputHolder.BenchmarkClsdForm();
 	solnArr[3] = outputHolder;
+	outputHolder = *I_crnt;
+
+	if(m_options.bBestImprovement) {
+		// printf("Search for beneficial single-agent moves...\n");
+		best_improvement(I_crnt, input, outputHolder);
+		benchmarks[4] = outputHolder.BenchmarkClsdForm();
+		solnArr[4] = outputHolder;
+	}
 
 	// printf("Original solution has value of %f\n", before_swap_benchmark);
 	// solnArr[0].PrintSolution();
 	double best = before_swap_benchmark;
 	int bestIndex = 0;
-	for(int i = 1 ; i < 4; i++){
+	for(int i = 1 ; i < 5; i++){
 		// printf("Swap %d solution has value of %f\n", i, benchmarks[i]);
 		// solnArr[i].PrintSolution();
 		if(benchmarks[i] >= best){
@@ -196,10 +231,40 @@ void MASP_Swap::single_swap(I_solution* I_crnt, MASPInput* input, I_solution& be
 	// delete &newPossibleSoln;
 }
 
+// Runs best-improvement search over single-agent moves starting from I_crnt
+void MASP_Swap::best_improvement(I_solution* I_crnt, MASPInput* input, I_solution& bestSoln){
+	if(DeadlinePassed()) {
+		// Not worth building the gain table
+		return;
+	}
+
+	bool** x_ij = new bool*[input->getN()];
+	for(int i = 0; i < input->getN(); i++) {
+		x_ij[i] = new bool[input->getM()];
+		for(int j = 0; j < input->getM(); j++) {
+			x_ij[i][j] = I_crnt->I_ij[i][j];
+		}
+	}
+
+	// Moves that break a task's requirement zero out Z, so the search stays valid
+	BestImprovementSearch(input, x_ij);
+
+	for(int i = 0; i < input->getN(); i++) {
+		for(int j = 0; j < input->getM(); j++) {
+			if(x_ij[i][j]) {
+				bestSoln.Update(input, i, j);
+			}
+		}
+		delete[] x_ij[i];
+	}
+	delete[] x_ij;
+}
+
+// Every candidate costs a few benchmarks, far more than reading the clock, so each loop reads it
 void MASP_Swap::two_swap(I_solution* I_crnt, MASPInput* input, I_solution& bestSoln){
 	I_solution newPossibleSoln(*I_crnt);
-	for(int i = 0 ; i < I_crnt->m_N; i++){
-		for(int j = i + 1 ; j < I_crnt->m_N; j++){
+	for(int i = 0 ; i < I_crnt->m_N && !DeadlinePassed(); i++){
+		for(int j = i + 1 ; j < I_crnt->m_N && !DeadlinePassed(); j++){
 			int currAgentTask = I_crnt->getTask(i);
 			int potentialSwapAgentTask = I_crnt->getTask(j);
 			if(currAgentTask == potentialSwapAgentTask){ //agents are already assigned to the same task and cant be swapped
@@ -230,9 +295,9 @@ void MASP_Swap::two_swap(I_solution* I_crnt, MASPInput* input, I_solution& bestS
 void MASP_Swap::three_swap(I_solution* I_crnt, MASPInput* input, I_solution& bestSoln){ //312 and 231 are only combos to check
 	I_solution newPossibleSolnOne(*I_crnt);
 	I_solution newPossibleSolnTwo(*I_crnt);
-	for(int i = 0 ; i < I_crnt->m_N; i++){
-		for(int j = i + 1 ; j < I_crnt->m_N; j++){
-			for(int k = j + 1 ; k < I_crnt->m_N ; k++){
+	for(int i = 0 ; i < I_crnt->m_N && !DeadlinePassed(); i++){
+		for(int j = i + 1 ; j < I_crnt->m_N && !DeadlinePassed(); j++){
+			for(int k = j + 1 ; k < I_crnt->m_N && !DeadlinePassed(); k++){
 				int ithTask = I_crnt->getTask(i);
 				int jthTask = I_crnt->getTask(j);
 				int kthTask = I_crnt->getTask(k);
@@ -287,10 +352,10 @@ void MASP_Swap::three_swap(I_solution* I_crnt, MASPInput* input, I_solution& bes
 // There are 9 assignments possible for 4 agents: 2143, 2341, 2413, 3142, 3421, 3412, 4123, 4312, 4321
 void MASP_Swap::four_swap(I_solution* I_crnt, MASPInput* input, I_solution& bestSoln){
 	I_solution newPossibleSolnOne(*I_crnt);
-	for(int i = 0 ; i < I_crnt->m_N; i++){
-		for(int j = i + 1 ; j < I_crnt->m_N; j++){
-			for(int k = j + 1 ; k < I_crnt->m_N ; k++){
-				for(int l = k + 1 ; l < I_crnt->m_N ; l++){
+	for(int i = 0 ; i < I_crnt->m_N && !DeadlinePassed(); i++){
+		for(int j = i + 1 ; j < I_crnt->m_N && !DeadlinePassed(); j++){
+			for(int k = j + 1 ; k < I_crnt->m_N && !DeadlinePassed(); k++){
+				for(int l = k + 1 ; l < I_crnt->m_N && !DeadlinePassed(); l++){
 					int ithTask = I_crnt->getTask(i);
 					int jthTask = I_crnt->getTask(j);
 					int kthTask = I_crnt->getTask(k);
@@ -453,77 +518,3 @@ void MASP_Swap::four_swap(I_solution* I_crnt, MASPInput* input, I_solution& best
 	// delete &newPossibleSolnOne;
 }
 
-// Takes balanced matching index and converts it into the corresponding task's index
-int MASP_Swap::get_task(int bal_j, MASPInput* input) {
-	int run_j = 0;
-	for(int j = 0; j < input->getM();j++) {
-		for(int i = 0; i < input->get_d_j(j); i++) {
-			if(bal_j == run_j) {
-				return j;
-			}
-			run_j++;
-		}
-		for(int i = 0; i < a_f; i++) {
-			if(bal_j == run_j) {
-				return j;
-			}
-			run_j++;
-		}
-	}
-
-	// If you made it here... something went wrong -> hard fail!
-	fprintf(stderr, "[MASP_Swap::get_task] : Could not find mapping from bal_j to task_j, bal_j = %d\n", bal_j);
-	exit(1);
-}
-
-// Takes balanced matching index and converts it into the corresponding agent's index.
-// Returns -1 if this is a phantom
-int MASP_Swap::get_agent(int i, MASPInput* input) {
-	if(i < input->getN()) {
-		return i;
-	}
-
-	// This is a phantom women
-	return -1;
-}
-
-// Determines if this is a floating task
-bool MASP_Swap::floating_task(int bal_j, MASPInput* input) {
-	int run_j = 0;
-	for(int j = 0; j < input->getM();j++) {
-		for(int i = 0; i < input->get_d_j(j); i++) {
-			if(bal_j == run_j) {
-				return false;
-			}
-			run_j++;
-		}
-		for(int i = 0; i < a_f; i++) {
-			if(bal_j == run_j) {
-				return true;
-			}
-			run_j++;
-		}
-	}
-
-	// If you made it here... something went wrong -> hard fail!
-	fprintf(stderr, "[MASP_Swap::floating_task] : Could not find mapping from bal_j to task_j, bal_j = %d\n", bal_j);
-	exit(1);
-}
-
-int MASP_Swap::resolve_task(int jj, MASPInput* input) {
-	int j = 0;
-	int j_track = 0;
-
-	while(j < input->getM()) {
-		if(jj >= j_track && jj < (j_track+input->get_d_j(j))) {
-			return j;
-		}
-
-		// Update j and j-tracker
-		j_track += input->get_d_j(j);
-		j++;
-	}
-
-	// This must be a floating task
-	return -1;
-}
@@ -0,0 +1,220 @@
+#include "MASP_TypeDP.h"
+#include "SolverRegistry.h"
+
+REGISTER_SOLVER(e_Algo_MASP_TYPEDP, "type-dp", MASP_TypeDP);
+
+MASP_TypeDP::MASP_TypeDP() {
+	if(SANITY_PRINT)
+		printf("Hello from MASP Type-DP Solver!\n");
+	m_nTypes = 0;
+	m_nVectors = 0;
+}
+
+
+void MASP_TypeDP::Solve(MASPInput* input, I_solution* I_crnt) {
+	if(SANITY_PRINT)
+		printf("\nStarting Type-DP solver\n");
+
+	int N = input->getN();
+	int M = input->getM();
+	m_PoissonB.ResetCalls();
+
+	// Group the agents into types
+	std::vector<int> agentType;
+	m_nTypes = input->AgentClasses(m_options.fSymmetryTol, agentType);
+	m_vTypeCount.assign(m_nTypes, 0);
+	m_vTypeAgent.assign(m_nTypes, -1);
+	std::vector<std::vector<int>> typeAgents(m_nTypes);
+	for(int i = 0; i < N; i++) {
+		int t = agentType.at(i);
+		if(m_vTypeAgent.at(t) < 0) {
+			m_vTypeAgent.at(t) = i;
+		}
+		m_vTypeCount.at(t)++;
+		typeAgents.at(t).push_back(i);
+	}
+
+	// Count vectors are mixed-radix numbers, make sure the tables fit
+	m_vStride.assign(m_nTypes, 1);
+	long int vectors = 1;
+	bool stopped = false;
+	for(int t = 0; t < m_nTypes && !stopped; t++) {
+		m_vStride.at(t) = vectors;
+		vectors *= m_vTypeCount.at(t) + 1;
+		if(vectors*(2*M + 1) > TYPEDP_MAX_ENTRIES) {
+			// Solve it like a run that ran out of time, the result is not proven optimal
+			fprintf(stderr, "[WARNING][MASP_TypeDP::Solve] : %d agent types are too many for the DP tables (try --symmetry-tol), using the heuristic\n", m_nTypes);
+			RequestStop();
+			stopped = true;
+			vectors = 1;
+		}
+	}
+	m_nVectors = vectors;
+
+	if(SANITY_PRINT)
+		printf(" %d agents in %d types, %d count vectors\n", N, m_nTypes, m_nVectors);
+
+	// Types that can do each task and their P_s tables
+	m_vvTaskTypes.assign(M, std::vector<int>());
+	m_vvP.assign(M, std::vector<double>());
+	for(int j = 0; j < M && !stopped; j++) {
+		for(int t = 0; t < m_nTypes; t++) {
+			if(input->iCanDoj(m_vTypeAgent.at(t), j)) {
+				m_vvTaskTypes.at(j).push_back(t);
+			}
+		}
+		stopped = !taskTable(input, j);
+	}
+
+	// Last task first, only the full fleet is needed at task 0
+	m_vvV.assign(M + 1, std::vector<double>());
+	m_vvV.at(M).assign(m_nVectors, 0);
+	m_vvV.at(M).at(0) = 1;
+	int full = m_nVectors - 1;
+	for(int j = M - 1; j >= 0 && !stopped; j--) {
+		m_vvV.at(j).assign(m_nVectors, 0);
+		int first = (j == 0) ? full : 0;
+		for(int r = first; r <= full; r++) {
+			if(StopRequested()) {
+				stopped = true;
+				break;
+			}
+			int c = -1;
+			m_vvV.at(j).at(r) = bestSplit(j, r, &c);
+			m_stats.nNodes++;
+		}
+	}
+
+	if(stopped) {
+		// Out of time before the DP finished (or the tables don't fit), fall back on the heuristic
+		if(m_options.bHeuristicStart) {
+			MASP_MatchGS heurstcSolver;
+			heurstcSolver.SetOptions(m_options);
+			heurstcSolver.Solve(input, I_crnt);
+		}
+	}
+	else if(m_vvV.at(0).at(full) > 0) {
+		// Walk the tasks forward, handing out agents of each type by the counts that reached the optimum
+		int r = full;
+		for(int j = 0; j < M; j++) {
+			int c = -1;
+			bestSplit(j, r, &c);
+			r -= c;
+			for(int t : m_vvTaskTypes.at(j)) {
+				int count = (c/m_vStride.at(t)) % (m_vTypeCount.at(t) + 1);
+				for(int k = 0; k < count; k++) {
+					I_crnt->Update(input, typeAgents.at(t).back(), j);
+					typeAgents.at(t).pop_back();
+				}
+			}
+
+			if(DEBUG_MASP_TYPEDP)
+				printf("Task %d: P_s = %f\n", j, m_vvP.at(j).at(c));
+		}
+	}
+
+	if(SANITY_PRINT) {
+		printf(" * finished\n");
+		printf("--------------------------------------------------------\n");
+		printf("Final solution: %f\n", stopped ? 0 : m_vvV.at(0).at(full));
+	}
+
+	m_stats.nPMFCalls += m_PoissonB.Calls();
+	m_vvP.clear();
+	m_vvV.clear();
+}
+
+/*
+ * Fills m_vvP[j] with P_s of task j for every count vector of the types that can do j.
+ * Returns false if the solver was asked to stop.
+ */
+bool MASP_TypeDP::taskTable(MASPInput* input, int j) {
+	const std::vector<int>& types = m_vvTaskTypes.at(j);
+	std::vector<double>& P = m_vvP.at(j);
+	P.assign(m_nVectors, 0);
+	int d_j = input->get_d_j(j);
+	if(types.empty()) {
+		m_vPMF.assign(1, 1.0);
+		P.at(0) = m_PoissonB.Tail(d_j, m_vPMF);
+		return true;
+	}
+
+	// Odometer over the counts of the other types, the first type's agents are added one at a time on top
+	int first = types.at(0);
+	double firstP = input->get_p_ij(m_vTypeAgent.at(first), j);
+	m_vDigit.assign(types.size(), 0);
+	int c = 0;
+	while(true) {
+		if(StopRequested()) {
+			return false;
+		}
+
+		m_vPMF.assign(1, 1.0);
+		for(unsigned int k = 1; k < types.size(); k++) {
+			double p = input->get_p_ij(m_vTypeAgent.at(types.at(k)), j);
+			for(int a = 0; a < m_vDigit.at(k); a++) {
+				m_PoissonB.AddTrial(m_vPMF, p);
+			}
+		}
+		for(int a = 0; a <= m_vTypeCount.at(first); a++) {
+			if(a > 0) {
+				m_PoissonB.AddTrial(m_vPMF, firstP);
+			}
+			P.at(c + a*m_vStride.at(first)) = m_PoissonB.Tail(d_j, m_vPMF);
+		}
+
+		unsigned int k = 1;
+		while(k < types.size() && m_vDigit.at(k) == m_vTypeCount.at(types.at(k))) {
+			c -= m_vDigit.at(k)*m_vStride.at(types.at(k));
+			m_vDigit.at(k) = 0;
+			k++;
+		}
+		if(k == types.size()) {
+			break;
+		}
+		m_vDigit.at(k)++;
+		c += m_vStride.at(types.at(k));
+	}
+
+	return true;
+}
+
+// Best P_j(c)*V_{j+1}(r - c) over c <= r, the c it was found at goes in bestC (-1 if every split gives 0)
+double MASP_TypeDP::bestSplit(int j, int r, int* bestC) {
+	const std::vector<int>& types = m_vvTaskTypes.at(j);
+	const std::vector<double>& P = m_vvP.at(j);
+	const std::vector<double>& next = m_vvV.at(j + 1);
+
+	// Task j can take up to the agents left of each type it can use, digits can't borrow so r - c is digit-wise
+	m_vDigit.assign(types.size(), 0);
+	m_vLimit.resize(types.size());
+	for(unsigned int k = 0; k < types.size(); k++) {
+		int t = types.at(k);
+		m_vLimit.at(k) = (r/m_vStride.at(t)) % (m_vTypeCount.at(t) + 1);
+	}
+
+	double best = 0;
+	*bestC = -1;
+	int c = 0;
+	while(true) {
+		double value = P[c]*next[r - c];
+		if(value > best) {
+			best = value;
+			*bestC = c;
+		}
+
+		unsigned int k = 0;
+		while(k < types.size() && m_vDigit[k] == m_vLimit[k]) {
+			c -= m_vDigit[k]*m_vStride[types[k]];
+			m_vDigit[k] = 0;
+			k++;
+		}
+		if(k == types.size()) {
+			break;
+		}
+		m_vDigit[k]++;
+		c += m_vStride[types[k]];
+	}
+
+	return best;
+}
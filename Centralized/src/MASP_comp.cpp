@@ -1,140 +1,274 @@
 #include "MASP_comp.h"
+#include "SolverRegistry.h"
+
+REGISTER_SOLVER(e_Algo_MASP_COMP, "comp", MASPComp);
 
 
 MASPComp::MASPComp() {
 	if(SANITY_PRINT)
 		printf("Hello from MASPComp Solver!\n");
-	fProbSuccess = 0;
-	bX_ij = NULL;
+	m_nChunks = 0;
 }
 
 
 void MASPComp::Solve(MASPInput* input, I_solution* I_crnt) {
-	// Create global best solution
-	bX_ij = new bool*[input->getN()];
-	// Create a local solution space
-	bool** x_ij = new bool*[input->getN()];
-	for(int i = 0; i < input->getN(); i++) {
-		x_ij[i] = new bool[input->getM()];
-		bX_ij[i] = new bool[input->getM()];
-		for(int j = 0; j < input->getM(); j++) {
-			x_ij[i][j] = false;
-			bX_ij[i][j] = false;
-		}
-	}
-	fProbSuccess = 0;
-
-	// Start recursive solver
-	assign_next(input, 0, x_ij, I_crnt);
-
-	// Sanity print
-	if(DEBUG_MASPC) {
-		printf("\nBest found solution: Z(I, C) = %f\n", fProbSuccess);
-		for(int i = 0; i < input->getN(); i++) {
-			for(int j = 0; j < input->getM(); j++) {
-				if(bX_ij[i][j]) {
-					printf("%d->%d\n",i,j);
-				}
+	int N = input->getN();
+	int M = input->getM();
+
+	// Tasks of each agent, an agent with none leaves no valid assignment
+	m_vvTasks.assign(N, std::vector<int>());
+	for(int i = 0; i < N; i++) {
+		for(int j = 0; j < M; j++) {
+			if(input->iCanDoj(i, j)) {
+				m_vvTasks.at(i).push_back(j);
 			}
 		}
+		if(m_vvTasks.at(i).empty()) {
+			if(SANITY_PRINT)
+				printf(" Agent %d can't do any task\n", i);
+			return;
+		}
+	}
+
+	// Agents with one task never move, the last agents with a choice split the assignments into chunks
+	int nThreads = std::max(1, m_options.nThreads);
+	m_vGray.clear();
+	m_vSplit.clear();
+	for(int i = 0; i < N; i++) {
+		if(m_vvTasks.at(i).size() > 1) {
+			m_vGray.push_back(i);
+		}
+	}
+	m_nChunks = 1;
+	while(nThreads > 1 && !m_vGray.empty() && m_nChunks < COMP_CHUNKS_PER_THREAD*nThreads) {
+		m_vSplit.push_back(m_vGray.back());
+		m_nChunks *= m_vvTasks.at(m_vGray.back()).size();
+		m_vGray.pop_back();
+	}
+	nThreads = std::min(nThreads, m_nChunks);
+
+	if(SANITY_PRINT)
+		printf(" Enumerating %zu agents in %d chunks on %d threads\n", m_vGray.size(), m_nChunks, nThreads);
+
+	m_vContexts.clear();
+	for(int t = 0; t < nThreads; t++) {
+		m_vContexts.emplace_back(new CompContext_t());
+		m_vContexts.back()->fBest = 0;
+		m_vContexts.back()->nBestChunk = -1;
+	}
+	m_pool.Reset(nThreads);
+	for(int c = 0; c < m_nChunks; c++) {
+		m_pool.Push(c % nThreads, [this, input, c](int t) {
+			enumerate(*m_vContexts.at(t), input, c);
+		});
+	}
+	m_pool.Run();
+
+	// Best over the threads, ties go to the first chunk so the result doesn't depend on the schedule
+	CompContext_t* best = NULL;
+	for(std::unique_ptr<CompContext_t>& ctx : m_vContexts) {
+		m_stats.Add(ctx->stats);
+		if(ctx->nBestChunk >= 0 && (best == NULL || ctx->fBest > best->fBest
+				|| (ctx->fBest == best->fBest && ctx->nBestChunk < best->nBestChunk))) {
+			best = ctx.get();
+		}
 	}
 
 	// Save found solution
-	for(int i = 0; i < input->getN(); i++) {
-		for(int j = 0; j < input->getM(); j++) {
-			if(bX_ij[i][j]) {
-				I_crnt->Update(input,i,j);
-			}
+	if(best != NULL) {
+		if(DEBUG_MASPC)
+			printf("\nBest found solution: Z(I, C) = %f\n", best->fBest);
+
+		for(int i = 0; i < N; i++) {
+			I_crnt->Update(input, i, best->vBest.at(i));
 		}
 	}
 
 	if(DEBUG_MASPC)
 		I_crnt->PrintSolution();
 
-	// Free memory
-	for(int i = 0; i < input->getN(); i++) {
-		delete[] x_ij[i];
+	m_vContexts.clear();
+}
+
+// Enumerates every assignment of chunk on ctx
+void MASPComp::enumerate(CompContext_t& ctx, MASPInput* input, int chunk) {
+	if(StopRequested()) {
+		return;
 	}
-	delete[] x_ij;
-	for(int i = 0; i < input->getN(); i++) {
-		delete[] bX_ij[i];
+
+	int N = input->getN();
+	int M = input->getM();
+
+	// Start from digit 0 of every enumerated agent, the chunk fixes the split agents
+	ctx.vTask.assign(N, -1);
+	ctx.vSlot.assign(N, -1);
+	ctx.vvAgents.assign(M, std::vector<int>());
+	ctx.vvPMF.resize(M);
+	ctx.vP.resize(M);
+	ctx.vUpdates.assign(M, 0);
+	for(int i = 0; i < N; i++) {
+		ctx.vTask.at(i) = m_vvTasks.at(i).at(0);
+	}
+	int rest = chunk;
+	for(int i : m_vSplit) {
+		int radix = m_vvTasks.at(i).size();
+		ctx.vTask.at(i) = m_vvTasks.at(i).at(rest % radix);
+		rest /= radix;
+	}
+	for(int i = 0; i < N; i++) {
+		std::vector<int>& agents = ctx.vvAgents.at(ctx.vTask.at(i));
+		ctx.vSlot.at(i) = agents.size();
+		agents.push_back(i);
+	}
+	ctx.nUncovered = 0;
+	for(int j = 0; j < M; j++) {
+		rebuild(ctx, input, j);
+		if((int)ctx.vvAgents.at(j).size() < input->get_d_j(j)) {
+			ctx.nUncovered++;
+		}
 	}
-	delete[] bX_ij;
-}
 
-void MASPComp::assign_next(MASPInput* input, int i, bool** x_ij, I_solution* I_crnt) {
-	// Check base case
-	if(i >= input->getN()) {
-		/// Hit base case
-		// Verify this is a valid assignment
-		if(valid_solution(input, x_ij)) {
-			// Determine Z
-			double Z = BenchmarkRec(input, x_ij);
-
-			// Is this better than our best solution?
-			if(Z > fProbSuccess) {
-				// Sanity print
-				if(DEBUG_MASPC)
-					printf("** Found better solution! Z(I, C) = %f\n", Z);
+	// Knuth's loopless reflected mixed-radix Gray code (TAOCP 7.2.1.1, Algorithm H)
+	int n = m_vGray.size();
+	ctx.vDigit.assign(n, 0);
+	ctx.vDir.assign(n, 1);
+	ctx.vFocus.resize(n + 1);
+	for(int k = 0; k <= n; k++) {
+		ctx.vFocus[k] = k;
+	}
 
-				// Update best found solution
-				fProbSuccess = Z;
-				for(int i = 0; i < input->getN(); i++) {
-					for(int j = 0; j < input->getM(); j++) {
-						bX_ij[i][j] = x_ij[i][j];
-					}
-				}
+	long int steps = 0;
+	while(true) {
+		// Score the assignment
+		ctx.stats.nNodes++;
+		if(ctx.nUncovered > 0) {
+			// Not valid
+			ctx.stats.nInvalidLeaves++;
+		}
+		else {
+			double Z = 1;
+			for(int j = 0; j < M; j++) {
+				Z *= ctx.vP[j];
 			}
-			else {
-				// Sanity print
+			ctx.stats.nLeaves++;
+
+			if(Z > ctx.fBest || (Z == ctx.fBest && chunk < ctx.nBestChunk)) {
 				if(DEBUG_MASPC)
-					printf("Z(I, C) = %f\n", Z);
+					printf("** Found better solution! Z(I, C) = %f\n", Z);
+
+				ctx.fBest = Z;
+				ctx.vBest = ctx.vTask;
+				ctx.nBestChunk = chunk;
 			}
 		}
-		// ELSE do nothing, not valid
-	}
-	else {
-		/// Recursive case
-		// Determine i for recursive step input
-		int next_i = i+1;
-		// Iterate through all possible assignments of x_ij for input i
-		for(int j = 0; j < input->getM(); j++) {
-			// Verify that i meets the requirements of j
-			if(input->iCanDoj(i,j)) {
-				// TODO: Verify that there are enough agents to cover other task
-				// Assign agent i to task j
-				x_ij[i][j] = true;
-				// Increment i and recurse
-				assign_next(input, next_i, x_ij, I_crnt);
-			}
-			// Reset i/j combo
-			x_ij[i][j] = false;
+
+		if((++steps % COMP_STOP_PERIOD) == 0 && StopRequested()) {
+			return;
+		}
+
+		// Next digit to change, the code is done when it runs off the end
+		int k = ctx.vFocus[0];
+		ctx.vFocus[0] = 0;
+		if(k == n) {
+			break;
+		}
+		int i = m_vGray[k];
+		int radix = m_vvTasks[i].size();
+		ctx.vDigit[k] += ctx.vDir[k];
+		move(ctx, input, i, m_vvTasks[i][ctx.vDigit[k]]);
+		if(ctx.vDigit[k] == 0 || ctx.vDigit[k] == radix - 1) {
+			ctx.vDir[k] = -ctx.vDir[k];
+			ctx.vFocus[k] = ctx.vFocus[k + 1];
+			ctx.vFocus[k + 1] = k + 1;
 		}
 	}
 }
 
-// Determine if this is a valid solution
-bool MASPComp::valid_solution(MASPInput* input, bool** x_ij) {
-	// Count the number of agents assigned to each task
-	for(int j = 0; j < input->getM(); j++) {
-		int agent_count = 0;
-		// Cycle through all agents
-		for(int i = 0; i < input->getN(); i++) {
-			if(x_ij[i][j]) {
-				agent_count++;
+// Puts agent i on task j, removing it from its current task first (if any)
+void MASPComp::move(CompContext_t& ctx, MASPInput* input, int i, int j) {
+	int from = ctx.vTask[i];
+	if(from >= 0) {
+		// Swap the last agent of the old task into i's slot
+		std::vector<int>& agents = ctx.vvAgents[from];
+		int last = agents.back();
+		agents[ctx.vSlot[i]] = last;
+		ctx.vSlot[last] = ctx.vSlot[i];
+		agents.pop_back();
+
+		int d_j = input->get_d_j(from);
+		if((int)agents.size() == d_j - 1) {
+			ctx.nUncovered++;
+		}
+		double p = input->get_p_ij(i, from);
+		if(p > 0.5 || ++ctx.vUpdates[from] >= COMP_REFRESH_PERIOD) {
+			// Dividing by 1 - p would blow up the rounding errors
+			rebuild(ctx, input, from);
+		}
+		else if(d_j > 0) {
+			// Undo the convolution with the agent's trial: q_k = (pmf_k - p*q_{k-1})/(1 - p)
+			std::vector<double>& pmf = ctx.vvPMF[from];
+			double below = 0;
+			double prev = 0;
+			for(int k = 0; k < d_j; k++) {
+				prev = (pmf[k] - p*prev)/(1 - p);
+				pmf[k] = prev;
+				below += prev;
 			}
+			ctx.vP[from] = std::min(std::max(1 - below, 0.0), 1.0);
 		}
+	}
+
+	ctx.vTask[i] = j;
+	std::vector<int>& agents = ctx.vvAgents[j];
+	ctx.vSlot[i] = agents.size();
+	agents.push_back(i);
 
-		// Check if we assigned enough agents to this task
-		if(agent_count < input->get_d_j(j)) {
-			// Not enough agents assigned to this task
-			return false;
+	int d_j = input->get_d_j(j);
+	if((int)agents.size() == d_j) {
+		ctx.nUncovered--;
+	}
+	if(++ctx.vUpdates[j] >= COMP_REFRESH_PERIOD) {
+		rebuild(ctx, input, j);
+	}
+	else if(d_j > 0) {
+		// Convolve with the agent's trial, only the terms below d_j are kept
+		std::vector<double>& pmf = ctx.vvPMF[j];
+		double p = input->get_p_ij(i, j);
+		for(int k = d_j - 1; k > 0; k--) {
+			pmf[k] = pmf[k]*(1 - p) + pmf[k - 1]*p;
+		}
+		pmf[0] *= 1 - p;
+		double below = 0;
+		for(int k = 0; k < d_j; k++) {
+			below += pmf[k];
 		}
+		ctx.vP[j] = std::min(std::max(1 - below, 0.0), 1.0);
 	}
-
-	// If we make it this far, all tasks must have enough agents
-	return true;
 }
 
+// Rebuilds the PMF and P_s of task j from the agents on it
+void MASPComp::rebuild(CompContext_t& ctx, MASPInput* input, int j) {
+	int d_j = input->get_d_j(j);
+	std::vector<double>& pmf = ctx.vvPMF[j];
+	pmf.assign(d_j, 0);
+	ctx.vUpdates[j] = 0;
+	if(d_j == 0) {
+		ctx.vP[j] = 1;
+		return;
+	}
 
+	pmf[0] = 1;
+	for(int i : ctx.vvAgents[j]) {
+		double p = input->get_p_ij(i, j);
+		for(int k = d_j - 1; k > 0; k--) {
+			pmf[k] = pmf[k]*(1 - p) + pmf[k - 1]*p;
+		}
+		pmf[0] *= 1 - p;
+	}
 
+	double below = 0;
+	for(int k = 0; k < d_j; k++) {
+		below += pmf[k];
+	}
+	ctx.vP[j] = std::min(std::max(1 - below, 0.0), 1.0);
+}
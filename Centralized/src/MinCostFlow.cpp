@@ -0,0 +1,116 @@
+#include "MinCostFlow.h"
+
+MinCostFlow::MinCostFlow() {}
+
+MinCostFlow::~MinCostFlow() {}
+
+// Clears the graph and creates n nodes, numbered 0 to n-1
+void MinCostFlow::Reset(int n) {
+	m_vEdges.clear();
+	m_vAdj.assign(n, std::vector<int>());
+}
+
+// Adds edge u -> v with the given capacity and non-negative cost, returns the edge's id
+int MinCostFlow::AddEdge(int u, int v, int capacity, double cost) {
+	if(cost < 0) {
+		fprintf(stderr, "[ERROR][MinCostFlow::AddEdge] : Negative cost %f on edge %d -> %d\n", cost, u, v);
+		exit(1);
+	}
+
+	int id = m_vEdges.size();
+	m_vEdges.push_back({v, capacity, cost});
+	m_vEdges.push_back({u, 0, -cost});
+	m_vAdj.at(u).push_back(id);
+	m_vAdj.at(v).push_back(id + 1);
+
+	return id;
+}
+
+/*
+ * Sends up to maxFlow units from s to t at minimum cost. Returns the amount sent,
+ * *cost is set to the total cost of the flow.
+ */
+int MinCostFlow::Solve(int s, int t, int maxFlow, double* cost) {
+	int n = m_vAdj.size();
+	// All costs start non-negative, so zero potentials are feasible
+	m_vPotential.assign(n, 0.0);
+
+	int flow = 0;
+	*cost = 0;
+	while(flow < maxFlow && shortestPath(s, t)) {
+		/*
+		 * Update the potentials. Nodes not settled before t get the distance to t, which
+		 * keeps every residual reduced cost non-negative without finishing Dijkstra.
+		 */
+		double dist_t = m_vDist[t];
+		for(int v = 0; v < n; v++) {
+			m_vPotential[v] += std::min(m_vDist[v], dist_t);
+		}
+
+		// Find the bottleneck along the path
+		int push = maxFlow - flow;
+		for(int v = t; v != s; v = m_vEdges[m_vPrevEdge[v] ^ 1].to) {
+			push = std::min(push, m_vEdges[m_vPrevEdge[v]].cap);
+		}
+
+		// Push flow
+		for(int v = t; v != s; v = m_vEdges[m_vPrevEdge[v] ^ 1].to) {
+			int e = m_vPrevEdge[v];
+			m_vEdges[e].cap -= push;
+			m_vEdges[e ^ 1].cap += push;
+			*cost += push*m_vEdges[e].cost;
+		}
+		flow += push;
+
+		if(DEBUG_MCF)
+			printf("MCF: pushed %d, flow = %d, cost = %f\n", push, flow, *cost);
+	}
+
+	return flow;
+}
+
+// Flow on edge id after Solve()
+int MinCostFlow::Flow(int id) {
+	// The residual edge's capacity is the flow pushed through id
+	return m_vEdges.at(id ^ 1).cap;
+}
+
+// Runs Dijkstra from s until t is settled, fills m_vDist/m_vPrevEdge. Returns false if t is unreachable
+bool MinCostFlow::shortestPath(int s, int t) {
+	typedef std::pair<double, int> Entry;
+	int n = m_vAdj.size();
+	m_vDist.assign(n, std::numeric_limits<double>::infinity());
+	m_vPrevEdge.assign(n, -1);
+	m_vDone.assign(n, false);
+
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue;
+	m_vDist[s] = 0;
+	queue.push(Entry(0, s));
+	while(!queue.empty()) {
+		int u = queue.top().second;
+		queue.pop();
+		if(m_vDone[u]) {
+			continue;
+		}
+		m_vDone[u] = true;
+		if(u == t) {
+			return true;
+		}
+
+		for(int e : m_vAdj[u]) {
+			const Edge_t& edge = m_vEdges[e];
+			if(edge.cap <= 0 || m_vDone[edge.to]) {
+				continue;
+			}
+			// Reduced cost, clamp round-off below zero
+			double reduced = std::max(0.0, edge.cost + m_vPotential[u] - m_vPotential[edge.to]);
+			if(m_vDist[u] + reduced < m_vDist[edge.to]) {
+				m_vDist[edge.to] = m_vDist[u] + reduced;
+				m_vPrevEdge[edge.to] = e;
+				queue.push(Entry(m_vDist[edge.to], edge.to));
+			}
+		}
+	}
+
+	return false;
+}
@@ -0,0 +1,179 @@
+#include "MoveGainTable.h"
+#include "Solver.h"
+
+MoveGainTable::MoveGainTable() {
+	m_N = 0;
+	m_M = 0;
+	m_nLeaves = 0;
+}
+
+MoveGainTable::~MoveGainTable() {}
+
+// Builds the table from the solver's current move cache (see Solver::InitDeltaCache)
+void MoveGainTable::Build(MASPInput* input, Solver* solver) {
+	m_N = input->getN();
+	m_M = input->getM();
+
+	// Size the tournament tree to the next power of two
+	m_nLeaves = 1;
+	while(m_nLeaves < m_N*m_M) {
+		m_nLeaves *= 2;
+	}
+	m_vLeafGain.assign(m_nLeaves, -INF);
+	m_vTree.assign(2*m_nLeaves, 0);
+	for(int l = 0; l < m_nLeaves; l++) {
+		m_vTree[m_nLeaves + l] = l;
+	}
+	for(int n = m_nLeaves - 1; n >= 1; n--) {
+		m_vTree[n] = m_vTree[2*n];
+	}
+
+	// Record who is on each task
+	m_vMembers.assign(m_M, std::vector<int>());
+	for(int i = 0; i < m_N; i++) {
+		if(solver->CachedTask(i) >= 0) {
+			m_vMembers.at(solver->CachedTask(i)).push_back(i);
+		}
+	}
+
+	m_vAddGain.assign(m_N*m_M, -INF);
+	m_vRemoveGain.assign(m_N, 0);
+	for(int j = 0; j < m_M; j++) {
+		refreshColumn(input, solver, j);
+	}
+	for(int i = 0; i < m_N; i++) {
+		refreshRow(input, solver, i);
+	}
+}
+
+/*
+ * Refreshes the table after agent i moved from from_j to to_j. Call this after
+ * Solver::ApplyMove() so that the cache already reflects the move.
+ */
+void MoveGainTable::OnMove(MASPInput* input, Solver* solver, int i, int from_j, int to_j) {
+	if(from_j == to_j) {
+		return;
+	}
+
+	// Update membership
+	if(from_j >= 0) {
+		std::vector<int>& members = m_vMembers.at(from_j);
+		for(long unsigned int k = 0; k < members.size(); k++) {
+			if(members[k] == i) {
+				members[k] = members.back();
+				members.pop_back();
+				break;
+			}
+		}
+		refreshColumn(input, solver, from_j);
+	}
+	if(to_j >= 0) {
+		m_vMembers.at(to_j).push_back(i);
+		refreshColumn(input, solver, to_j);
+	}
+
+	// Removal gains changed for everyone on the two tasks (this includes i)
+	if(from_j >= 0) {
+		for(int k : m_vMembers.at(from_j)) {
+			refreshRow(input, solver, k);
+		}
+	}
+	if(to_j >= 0) {
+		for(int k : m_vMembers.at(to_j)) {
+			refreshRow(input, solver, k);
+		}
+	}
+	else {
+		refreshRow(input, solver, i);
+	}
+
+	// Agents on other tasks only saw their entries in the two columns change
+	for(int k = 0; k < m_N; k++) {
+		int task_k = solver->CachedTask(k);
+		if(task_k != from_j && task_k != to_j) {
+			if(from_j >= 0) {
+				setEntry(k, from_j, m_vAddGain[k*m_M + from_j] + m_vRemoveGain[k]);
+			}
+			if(to_j >= 0) {
+				setEntry(k, to_j, m_vAddGain[k*m_M + to_j] + m_vRemoveGain[k]);
+			}
+		}
+	}
+}
+
+// Gets the best move in the table. Returns false if there are no legal moves.
+bool MoveGainTable::BestMove(int* i, int* j, double* gain) {
+	if(m_nLeaves == 0) {
+		return false;
+	}
+
+	int leaf = m_vTree[1];
+	if(m_vLeafGain[leaf] <= -INF) {
+		return false;
+	}
+
+	*i = leaf/m_M;
+	*j = leaf%m_M;
+	*gain = m_vLeafGain[leaf];
+
+	return true;
+}
+
+// Gets the change in log(Z) from moving agent i to task j
+double MoveGainTable::Gain(int i, int j) {
+	return m_vLeafGain.at(i*m_M + j);
+}
+
+// Re-computes the gain of adding each agent to task j
+void MoveGainTable::refreshColumn(MASPInput* input, Solver* solver, int j) {
+	double log_Ps = safeLog(solver->CachedPs(j));
+	for(int i = 0; i < m_N; i++) {
+		if(solver->CachedTask(i) != j && input->iCanDoj(i, j)) {
+			m_vAddGain[i*m_M + j] = safeLog(solver->PsWith(input, i, j)) - log_Ps;
+		}
+		else {
+			m_vAddGain[i*m_M + j] = -INF;
+		}
+	}
+}
+
+// Re-computes the gain of removing agent i from its task and pushes its row into the tree
+void MoveGainTable::refreshRow(MASPInput* input, Solver* solver, int i) {
+	int task_i = solver->CachedTask(i);
+	if(task_i >= 0) {
+		m_vRemoveGain[i] = safeLog(solver->PsWithout(input, i, task_i)) - safeLog(solver->CachedPs(task_i));
+	}
+	else {
+		m_vRemoveGain[i] = 0;
+	}
+
+	for(int j = 0; j < m_M; j++) {
+		if(m_vAddGain[i*m_M + j] <= -INF) {
+			setEntry(i, j, -INF);
+		}
+		else {
+			setEntry(i, j, m_vAddGain[i*m_M + j] + m_vRemoveGain[i]);
+		}
+	}
+}
+
+// Sets a single entry in the tournament tree
+void MoveGainTable::setEntry(int i, int j, double gain) {
+	int leaf = i*m_M + j;
+	if(m_vAddGain[leaf] <= -INF) {
+		gain = -INF;
+	}
+	m_vLeafGain[leaf] = gain;
+
+	// Replay the matches on the way up
+	for(int n = (m_nLeaves + leaf)/2; n >= 1; n /= 2) {
+		int left = m_vTree[2*n];
+		int right = m_vTree[2*n + 1];
+		m_vTree[n] = (m_vLeafGain[right] > m_vLeafGain[left]) ? right : left;
+	}
+}
+
+// log() that maps P_s = 0 to a large negative number instead of -inf
+double MoveGainTable::safeLog(double x) {
+	return log(std::max(x, 1e-300));
+}
@@ -1,6 +1,8 @@
 #include "PoissonBinomial.h"
 
-PoissonBinomial::PoissonBinomial() {}
+PoissonBinomial::PoissonBinomial() {
+	m_nCalls = 0;
+}
 
 PoissonBinomial::~PoissonBinomial() {}
 
@@ -10,6 +12,7 @@ PoissonBinomial::~PoissonBinomial() {}
  * closed-form Fourier transform to calculate P(K=k).
  */
 double PoissonBinomial::PMF(int k, int n, std::vector<double>& p_values) {
+	m_nCalls++;
 	if((int64_t)n != (int64_t)p_values.size()) {
 		// These should be the same... hard fail!
 		fprintf(stderr, "[ERROR] : I_solution::poissonBinomialPMF : n = %d != |p_values| = %ld\n", n, p_values.size());
@@ -84,6 +87,130 @@ double PoissonBinomial::P_s(int d_j, int n, std::vector<double>& p_values) {
 	return Ps;
 }
 
+/*
+ * Builds the full PMF of the Poisson-Binomial distribution for the trials in p_values by
+ * convolving one trial at a time. pmf[k] is the probability of exactly k successes and
+ * pmf has size |p_values| + 1. This is O(n^2) but avoids the complex arithmetic of PMF().
+ */
+void PoissonBinomial::BuildPMF(std::vector<double>& p_values, std::vector<double>& pmf) {
+	m_nCalls++;
+	pmf.clear();
+	// With no trials, zero successes is certain
+	pmf.push_back(1.0);
+	for(double p : p_values) {
+		AddTrial(pmf, p);
+	}
+}
+
+// Adds a single trial with probability p to an existing PMF (O(n))
+void PoissonBinomial::AddTrial(std::vector<double>& pmf, double p) {
+	int n = static_cast<int>(pmf.size());
+	pmf.push_back(pmf.at(n-1)*p);
+	// Walk backwards so that pmf[k-1] is still the old value when we read it
+	for(int k = n-1; k > 0; k--) {
+		pmf[k] = pmf[k]*(1-p) + pmf[k-1]*p;
+	}
+	pmf[0] *= (1-p);
+}
+
+// Removes a single trial with probability p from an existing PMF (O(n))
+void PoissonBinomial::RemoveTrial(std::vector<double>& pmf, double p) {
+	int n = static_cast<int>(pmf.size()) - 1;
+	if(n <= 0) {
+		// Nothing to remove... hard fail!
+		fprintf(stderr, "[ERROR] : PoissonBinomial::RemoveTrial : removing trial from empty PMF\n");
+		exit(1);
+	}
+
+	/*
+	 * De-convolve the trial. Running the recurrence forward divides by (1-p) and running it
+	 * backwards divides by p, so pick the direction that keeps the division stable.
+	 */
+	if(p <= 0.5) {
+		pmf[0] = pmf[0]/(1-p);
+		for(int k = 1; k < n; k++) {
+			pmf[k] = (pmf[k] - p*pmf[k-1])/(1-p);
+		}
+	}
+	else {
+		double next = pmf[n]/p;
+		for(int k = n-1; k >= 0; k--) {
+			double q_k = next;
+			next = (pmf[k] - (1-p)*q_k)/p;
+			pmf[k+1] = q_k;
+		}
+		// Shift down by one, pmf[k+1] holds q_k
+		for(int k = 0; k < n; k++) {
+			pmf[k] = pmf[k+1];
+		}
+	}
+	pmf.pop_back();
+
+	// Round-off can push near-zero values slightly negative
+	for(int k = 0; k < n; k++) {
+		if(pmf[k] < 0) {
+			pmf[k] = 0;
+		}
+	}
+}
+
+// Probability of d_j or more successes given a PMF (O(n))
+double PoissonBinomial::Tail(int d_j, std::vector<double>& pmf) {
+	m_nCalls++;
+	double Ps = 0;
+	for(int k = std::max(d_j, 0); k < static_cast<int>(pmf.size()); k++) {
+		Ps += pmf[k];
+	}
+
+	return Ps;
+}
+
+// Probability of d_j or more successes after adding a trial with probability p (O(n), pmf is unchanged)
+double PoissonBinomial::TailWith(int d_j, std::vector<double>& pmf, double p) {
+	// P(X + B >= d) = P(X >= d) + p*P(X = d-1)
+	double Ps = Tail(d_j, pmf);
+	if(d_j >= 1 && d_j - 1 < static_cast<int>(pmf.size())) {
+		Ps += p*pmf[d_j-1];
+	}
+
+	return Ps;
+}
+
+// Probability of d_j or more successes after removing a trial with probability p (O(n), pmf is unchanged)
+double PoissonBinomial::TailWithout(int d_j, std::vector<double>& pmf, double p) {
+	int n = static_cast<int>(pmf.size()) - 1;
+	if(d_j > n - 1) {
+		// Not enough trials left to reach d_j
+		return 0;
+	}
+	if(d_j <= 0) {
+		return 1;
+	}
+
+	/*
+	 * With X = X' + B, P(X >= d) = P(X' >= d) + p*P(X' = d-1), so we only need the single
+	 * de-convolved value q_{d-1}. Run the stable recurrence up to it without touching pmf.
+	 */
+	double Ps = 0;
+	if(p <= 0.5) {
+		double q = pmf[0]/(1-p);
+		for(int k = 1; k <= d_j - 1; k++) {
+			q = (pmf[k] - p*q)/(1-p);
+		}
+		Ps = Tail(d_j, pmf) - p*std::max(q, 0.0);
+	}
+	else {
+		// Backwards from the top, summing q_k for k >= d_j along the way
+		double q = pmf[n]/p;
+		for(int k = n-1; k >= d_j; k--) {
+			Ps += std::max(q, 0.0);
+			q = (pmf[k] - (1-p)*q)/p;
+		}
+	}
+
+	return std::min(std::max(Ps, 0.0), 1.0);
+}
+
 
 
 //
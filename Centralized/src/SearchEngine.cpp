@@ -0,0 +1,634 @@
+#include "SearchEngine.h"
+
+SearchEngine::SearchEngine() {
+	m_pInput = NULL;
+	m_nN = 0;
+	m_nM = 0;
+	m_nDepth = 0;
+	m_nRequired = 0;
+	m_pX = NULL;
+	m_bBound = false;
+	m_pPoissonB = NULL;
+	m_nApplied = 0;
+	m_nVarOrder = e_VarOrder_Static;
+	m_nValueOrder = e_ValueOrder_Index;
+	m_bPropagate = false;
+	m_nForced = 0;
+	m_nFailed = 0;
+}
+
+SearchEngine::~SearchEngine() {
+	for(int i = 0; i < m_nN; i++) {
+		delete[] m_pX[i];
+	}
+	delete[] m_pX;
+}
+
+/*
+ * Sets up a search over input that assigns agent order[i] at depth i (static ordering).
+ * With bound set the engine also keeps the optimistic bound, evaluated with poissonB.
+ */
+void SearchEngine::Init(MASPInput* input, const std::vector<int>& order, bool bound, PoissonBinomial* poissonB) {
+	if((int)order.size() != input->getN() || (bound && poissonB == NULL)) {
+		fprintf(stderr, "[ERROR][SearchEngine::Init] : Bad agent order or missing Poisson-Binomial helper\n");
+		exit(1);
+	}
+
+	// Free the last assignment matrix
+	for(int i = 0; i < m_nN; i++) {
+		delete[] m_pX[i];
+	}
+	delete[] m_pX;
+
+	m_pInput = input;
+	m_nN = input->getN();
+	m_nM = input->getM();
+	m_nDepth = 0;
+	m_vOrder = order;
+	m_vRank.assign(m_nN, 0);
+	for(int i = 0; i < m_nN; i++) {
+		m_vRank[m_vOrder[i]] = i;
+	}
+	m_vvAgentCanDo.assign(m_nN, std::vector<int>());
+	m_vSupply.assign(m_nM, 0);
+	for(int a = 0; a < m_nN; a++) {
+		for(int j = 0; j < m_nM; j++) {
+			if(input->iCanDoj(a, j)) {
+				m_vvAgentCanDo[a].push_back(j);
+				m_vSupply[j]++;
+			}
+		}
+	}
+	m_vTask.assign(m_nN, -1);
+	m_vCount.assign(m_nM, 0);
+	m_vRemaining.assign(m_nM, 0);
+	m_nRequired = 0;
+	for(int j = 0; j < m_nM; j++) {
+		m_vRemaining[j] = input->get_d_j(j);
+		m_nRequired += input->get_d_j(j);
+	}
+	m_pX = new bool*[m_nN];
+	for(int i = 0; i < m_nN; i++) {
+		m_pX[i] = new bool[m_nM];
+		for(int j = 0; j < m_nM; j++) {
+			m_pX[i][j] = false;
+		}
+	}
+	m_vvVisit.assign(m_nN, std::vector<int>());
+	for(int i = 0; i < m_nN; i++) {
+		m_vvVisit[i].reserve(m_nM);
+	}
+	m_vNext.assign(m_nN + 1, 0);
+	m_vSame.assign(m_nN, -1);
+	m_nVarOrder = e_VarOrder_Static;
+	m_nValueOrder = e_ValueOrder_Index;
+	m_vChosen.assign(m_nN + 1, false);
+	m_vGain.assign(m_nM, 0);
+	m_bPropagate = false;
+	m_vForced.assign(m_nN + 1, -1);
+	m_vMoved.assign(m_nN + 1, -1);
+	m_nForced = 0;
+	m_nFailed = 0;
+
+	m_bBound = bound;
+	m_pPoissonB = poissonB;
+	m_nApplied = 0;
+	if(m_bBound) {
+		// Root bound: every agent counts towards every task it can do
+		m_vvPMF.assign(m_nM, std::vector<double>());
+		m_vTail.assign(m_nM, 1);
+		std::vector<double> p_values;
+		for(int j = 0; j < m_nM; j++) {
+			p_values.clear();
+			for(int i = 0; i < m_nN; i++) {
+				if(input->iCanDoj(i, j)) {
+					p_values.push_back(input->get_p_ij(i, j));
+				}
+			}
+			m_pPoissonB->BuildPMF(p_values, m_vvPMF[j]);
+			m_vvPMF[j].reserve(m_nN + 1);
+			m_vTail[j] = m_pPoissonB->Tail(input->get_d_j(j), m_vvPMF[j]);
+		}
+
+		// Room for a full PMF per task and depth on the trail
+		m_vOther.assign(m_nN, 1);
+		m_vvWithout.assign(m_nN, std::vector<double>(m_nM, 0));
+		m_vvTrailTail.assign(m_nN, std::vector<double>(m_nM, 0));
+		m_vvvTrail.assign(m_nN, std::vector<std::vector<double>>(m_nM));
+		for(int i = 0; i < m_nN; i++) {
+			for(int j = 0; j < m_nM; j++) {
+				m_vvvTrail[i][j].reserve(m_nN + 1);
+			}
+		}
+	}
+}
+
+/*
+ * Treats agents with the same agentClass[i] as interchangeable (see MASPInput::AgentClasses()),
+ * to be called after Init(). Returns the number of agents tied to an earlier agent.
+ */
+int SearchEngine::SetClasses(const std::vector<int>& agentClass) {
+	if((int)agentClass.size() != m_nN || m_nDepth != 0) {
+		fprintf(stderr, "[ERROR][SearchEngine::SetClasses] : Expected a class for each of the %d agents at the root\n", m_nN);
+		exit(1);
+	}
+
+	// An agent is only assigned once the agent of its class before it is, and takes a task at or after its task
+	int tied = 0;
+	std::vector<int> order(m_nN);
+	for(int a = 0; a < m_nN; a++) {
+		order[m_vRank[a]] = a;
+	}
+	std::vector<int> last(m_nN, -1);
+	for(int agent : order) {
+		m_vSame[agent] = last[agentClass[agent]];
+		last[agentClass[agent]] = agent;
+		if(m_vSame[agent] >= 0) {
+			tied++;
+		}
+	}
+
+	return tied;
+}
+
+/*
+ * Selects the agent and task orders (e_VarOrder_*, e_ValueOrder_*), to be called after
+ * Init(). With dynamic agent ordering, ties go to the agent first in Init()'s order.
+ */
+void SearchEngine::SetOrdering(int varOrder, int valueOrder) {
+	if(m_nDepth != 0) {
+		fprintf(stderr, "[ERROR][SearchEngine::SetOrdering] : Orders can only change at the root\n");
+		exit(1);
+	}
+
+	m_nVarOrder = varOrder;
+	m_nValueOrder = valueOrder;
+	m_vChosen.assign(m_nN + 1, false);
+}
+
+// Turns constraint propagation at each node on or off, to be called after Init()
+void SearchEngine::SetPropagation(bool propagate) {
+	if(m_nDepth != 0) {
+		fprintf(stderr, "[ERROR][SearchEngine::SetPropagation] : Propagation can only change at the root\n");
+		exit(1);
+	}
+
+	m_bPropagate = propagate;
+	m_vChosen.assign(m_nN + 1, false);
+}
+
+// Searches the subtree below the current state. Returns false if the hooks stopped it.
+bool SearchEngine::Run(SearchHooks& hooks) {
+	int base = m_nDepth;
+	if(!enter(hooks)) {
+		return false;
+	}
+	return search(hooks, base);
+}
+
+/*
+ * Rebuilds a state saved by Save() from the root: replays path, calling hooks.OnReplay()
+ * after each step, and sets where each node on it continues. Returns false if the state
+ * doesn't fit this search (different input or options).
+ */
+bool SearchEngine::Restore(SearchHooks& hooks, const std::vector<int>& path, const std::vector<int>& next) {
+	if(m_nDepth != 0 || path.size() != next.size() || (int)path.size() > m_nN) {
+		return false;
+	}
+
+	for(unsigned int d = 0; d < path.size(); d++) {
+		prepare();
+		// The search took path[d] just before moving on to next[d]
+		if(next[d] < 1 || next[d] > (int)m_vvVisit[d].size() || m_vvVisit[d][next[d] - 1] != path[d]) {
+			while(m_nDepth > 0) {
+				Pop();
+			}
+			return false;
+		}
+		m_vNext[d] = next[d];
+		Push(path[d]);
+		hooks.OnReplay(*this, d, path[d]);
+	}
+
+	// The saved search already counted the nodes on the path
+	m_nForced = 0;
+	m_nFailed = 0;
+	return true;
+}
+
+// Continues a search restored by Restore() until the whole tree is done. Returns false if the hooks stopped it.
+bool SearchEngine::Resume(SearchHooks& hooks) {
+	if(!enter(hooks)) {
+		while(m_nDepth > 0) {
+			Pop();
+		}
+		return false;
+	}
+	return search(hooks, 0);
+}
+
+// Fills path with the tasks taken at depths 0..Depth()-1 and next with the next child each of those nodes tries
+void SearchEngine::Save(std::vector<int>& path, std::vector<int>& next) {
+	Path(path);
+	next.assign(m_vNext.begin(), m_vNext.begin() + m_nDepth);
+}
+
+// Searches on from the node just entered until the subtree at depth base is done
+bool SearchEngine::search(SearchHooks& hooks, int base) {
+	bool stopped = false;
+	while(!stopped) {
+		int d = m_nDepth;
+		if(d < m_nN && m_vNext[d] < (int)m_vvVisit[d].size()) {
+			// Try the next child of this node
+			int j = m_vvVisit[d][m_vNext[d]++];
+			Push(j);
+			if(hooks.OnAssign(*this, d, j)) {
+				stopped = !enter(hooks);
+			}
+			else {
+				Pop();
+			}
+		}
+		else if(d == base) {
+			// Searched the whole subtree
+			return true;
+		}
+		else {
+			// Done with this node, back to its parent
+			Pop();
+		}
+	}
+
+	// Stopped early, unwind to where we started
+	while(m_nDepth > base) {
+		Pop();
+	}
+	return false;
+}
+
+// Assigns the agent at the current depth to task j and moves one level down
+void SearchEngine::Push(int j) {
+	if((m_nVarOrder == e_VarOrder_Dynamic || m_bPropagate) && !m_vChosen[m_nDepth]) {
+		// Replaying a path, pick the agent the search picked
+		select();
+	}
+
+	int agent = m_vOrder[m_nDepth];
+	for(int t : m_vvAgentCanDo[agent]) {
+		m_vSupply[t]--;
+	}
+	m_vTask[agent] = j;
+	m_pX[agent][j] = true;
+	if(m_vRemaining[j] > 0) {
+		m_vRemaining[j]--;
+		m_nRequired--;
+	}
+	m_vCount[j]++;
+	m_nDepth++;
+	m_vChosen[m_nDepth] = false;
+}
+
+// Undoes the last Push()
+void SearchEngine::Pop() {
+	m_nDepth--;
+	if(m_bBound && m_nApplied > m_nDepth) {
+		boundUndo(m_nDepth);
+		m_nApplied = m_nDepth;
+	}
+
+	int agent = m_vOrder[m_nDepth];
+	int j = m_vTask[agent];
+	m_vCount[j]--;
+	if(m_vCount[j] < m_pInput->get_d_j(j)) {
+		m_vRemaining[j]++;
+		m_nRequired++;
+	}
+	m_pX[agent][j] = false;
+	m_vTask[agent] = -1;
+	for(int t : m_vvAgentCanDo[agent]) {
+		m_vSupply[t]++;
+	}
+
+	// Leaving the node below, the agent propagation moved up there goes back
+	int below = m_nDepth + 1;
+	if(m_vMoved[below] >= 0) {
+		std::rotate(m_vOrder.begin() + below, m_vOrder.begin() + below + 1, m_vOrder.begin() + m_vMoved[below] + 1);
+		m_vMoved[below] = -1;
+	}
+	m_vChosen[below] = false;
+}
+
+// Fills path with the tasks taken at depths 0..Depth()-1
+void SearchEngine::Path(std::vector<int>& path) {
+	path.clear();
+	for(int d = 0; d < m_nDepth; d++) {
+		path.push_back(m_vTask[m_vOrder[d]]);
+	}
+}
+
+/*
+ * Optimistic bound of the current state, to be called from OnAssign(): agents above the
+ * current depth keep their tasks and every unassigned agent counts towards every task it
+ * can do. Costs O(|CanDo|) since the parent node already computed its tails without the
+ * agent it assigns.
+ */
+double SearchEngine::Bound() {
+	int d = m_nDepth - 1;
+	if(!m_bBound || d < 0 || m_nApplied != d) {
+		fprintf(stderr, "[ERROR][SearchEngine::Bound] : Bound is only available right after a child is assigned\n");
+		exit(1);
+	}
+
+	int task = m_vTask[m_vOrder[d]];
+	double bound = m_vOther[d];
+	const std::vector<int>& canDo = CanDo(d);
+	for(unsigned int k = 0; k < canDo.size(); k++) {
+		int t = canDo[k];
+		bound *= (t == task) ? m_vTail[t] : m_vvWithout[d][k];
+	}
+
+	return bound;
+}
+
+// Enters the node at the current depth, returns false if the hooks stopped the search
+bool SearchEngine::enter(SearchHooks& hooks) {
+	if(!hooks.OnNode(*this)) {
+		return false;
+	}
+
+	if(m_nDepth >= m_nN) {
+		hooks.OnLeaf(*this);
+	}
+	else {
+		prepare();
+	}
+
+	return true;
+}
+
+// Picks the agent of the node at the current depth and the tasks it tries
+void SearchEngine::prepare() {
+	if((m_nVarOrder == e_VarOrder_Dynamic || m_bPropagate) && !m_vChosen[m_nDepth]) {
+		select();
+	}
+	if(m_bBound) {
+		boundEnter();
+	}
+	orderTasks();
+	m_vNext[m_nDepth] = 0;
+
+	if(m_bPropagate) {
+		if(m_vForced[m_nDepth] == PROPAGATE_FAIL) {
+			m_nFailed++;
+		}
+		else if(m_vForced[m_nDepth] >= 0) {
+			m_nForced++;
+		}
+	}
+}
+
+// Picks the agent of the node at the current depth (dynamic ordering or propagation)
+void SearchEngine::select() {
+	int d = m_nDepth;
+	m_vForced[d] = -1;
+	if(m_bPropagate) {
+		int agent = -1;
+		int task = -1;
+		if(!propagate(&agent, &task)) {
+			m_vForced[d] = PROPAGATE_FAIL;
+		}
+		else if(agent >= 0) {
+			m_vForced[d] = task;
+			if(m_nVarOrder == e_VarOrder_Dynamic) {
+				m_vOrder[d] = agent;
+			}
+			else if(m_vOrder[d] != agent) {
+				// Move the forced agent up from later in the static order, the agents in between keep their order
+				int p = d + 1;
+				while(m_vOrder[p] != agent) {
+					p++;
+				}
+				std::rotate(m_vOrder.begin() + d, m_vOrder.begin() + p, m_vOrder.begin() + p + 1);
+				m_vMoved[d] = p;
+			}
+			m_vChosen[d] = true;
+
+			if(DEBUG_SEARCH)
+				printf("Depth %d: agent %d is forced to task %d\n", d, agent, task);
+			return;
+		}
+	}
+
+	if(m_nVarOrder == e_VarOrder_Dynamic) {
+		choose();
+	}
+	m_vChosen[d] = true;
+}
+
+/*
+ * Looks for a move the uncovered demand forces at the current depth. Returns false if
+ * the state can't be completed, otherwise puts a forced agent and its task in agent and
+ * task (-1 if nothing is forced). Ties go to the agent first in Init()'s order, agents
+ * whose class-mate before them is still unassigned are not picked.
+ */
+bool SearchEngine::propagate(int* agent, int* task) {
+	*agent = -1;
+	*task = -1;
+
+	// Agents left over once every task has its demand
+	int slack = Unassigned() - m_nRequired;
+	if(slack < 0) {
+		return false;
+	}
+	for(int t = 0; t < m_nM; t++) {
+		if(m_vRemaining[t] > m_vSupply[t]) {
+			return false;
+		}
+	}
+
+	for(int a = 0; a < m_nN; a++) {
+		if(m_vTask[a] >= 0) {
+			continue;
+		}
+
+		// A task with no spare supply needs this agent, without slack so does its only task with uncovered demand
+		int need = -1;
+		int open = 0;
+		int only = -1;
+		for(int t : m_vvAgentCanDo[a]) {
+			if(m_vRemaining[t] > 0) {
+				open++;
+				only = t;
+				if(m_vSupply[t] == m_vRemaining[t]) {
+					if(need >= 0) {
+						// Two tasks need all their agents, this one included
+						return false;
+					}
+					need = t;
+				}
+			}
+		}
+		if(slack == 0) {
+			if(open == 0) {
+				// Nothing left this agent could cover
+				return false;
+			}
+			if(need < 0 && open == 1) {
+				need = only;
+			}
+		}
+
+		bool free = (m_vSame[a] < 0 || m_vTask[m_vSame[a]] >= 0);
+		if(need >= 0 && free && (*agent < 0 || m_vRank[a] < m_vRank[*agent])) {
+			*agent = a;
+			*task = need;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * Picks the agent of the node at the current depth (dynamic ordering). Agents that are forced,
+ * i.e. can do a task whose uncovered demand needs every unassigned agent that can do it, go
+ * first. Ties go in Init()'s order. Agents whose class-mate before them is still unassigned
+ * wait for it.
+ */
+void SearchEngine::choose() {
+	int best = -1;
+	bool bestForced = false;
+	for(int a = 0; a < m_nN; a++) {
+		if(m_vTask[a] >= 0 || (m_vSame[a] >= 0 && m_vTask[m_vSame[a]] < 0)) {
+			continue;
+		}
+
+		// Is there a task this agent can do that has no spare supply?
+		bool forced = false;
+		for(int t : m_vvAgentCanDo[a]) {
+			if(m_vRemaining[t] > 0 && m_vSupply[t] <= m_vRemaining[t]) {
+				forced = true;
+			}
+		}
+
+		if(best < 0 || (forced && !bestForced) || (forced == bestForced && m_vRank[a] < m_vRank[best])) {
+			best = a;
+			bestForced = forced;
+		}
+	}
+
+	m_vOrder[m_nDepth] = best;
+	m_vChosen[m_nDepth] = true;
+
+	if(DEBUG_SEARCH)
+		printf("Depth %d branches on agent %d (forced %d)\n", m_nDepth, best, bestForced);
+}
+
+/*
+ * Fills the tasks the node at the current depth tries, in the order it tries them. Tasks
+ * before the one the agent's class-mate took are skipped. By gain, the tasks go in order
+ * of the bound of their child (relative to the bound without the agent) when the engine
+ * keeps the bound, otherwise tasks with uncovered demand go first by p_ij. With propagation
+ * the node only tries its forced task, none if it can't be completed, and without slack only
+ * the tasks with uncovered demand.
+ */
+void SearchEngine::orderTasks() {
+	int d = m_nDepth;
+	int agent = m_vOrder[d];
+	int floor = (m_vSame[agent] >= 0) ? m_vTask[m_vSame[agent]] : 0;
+	const std::vector<int>& canDo = CanDo(d);
+	std::vector<int>& visit = m_vvVisit[d];
+
+	visit.clear();
+	int forced = m_bPropagate ? m_vForced[d] : -1;
+	if(forced == PROPAGATE_FAIL) {
+		return;
+	}
+	bool tight = m_bPropagate && Unassigned() == m_nRequired;
+	for(unsigned int k = 0; k < canDo.size(); k++) {
+		int t = canDo[k];
+		if(t < floor || (forced >= 0 && t != forced) || (tight && m_vRemaining[t] == 0)) {
+			continue;
+		}
+		visit.push_back(t);
+
+		if(m_nValueOrder == e_ValueOrder_Gain) {
+			if(m_bBound) {
+				// Child bound is the bound without the agent times tail/without of the task it takes
+				double without = m_vvWithout[d][k];
+				m_vGain[t] = (without > 0) ? m_vTail[t]/without : ((m_vTail[t] > 0) ? INF : 0);
+			}
+			else {
+				m_vGain[t] = m_pInput->get_p_ij(agent, t) + ((m_vRemaining[t] > 0) ? 1 : 0);
+			}
+		}
+	}
+
+	if(m_nValueOrder == e_ValueOrder_Gain) {
+		// Insertion sort, stable and without the buffer std::stable_sort allocates
+		for(unsigned int k = 1; k < visit.size(); k++) {
+			int t = visit[k];
+			int l = k;
+			while(l > 0 && m_vGain[visit[l - 1]] < m_vGain[t]) {
+				visit[l] = visit[l - 1];
+				l--;
+			}
+			visit[l] = t;
+		}
+	}
+}
+
+// Brings the bound PMFs up to the current depth and prepares the bounds of its children
+void SearchEngine::boundEnter() {
+	while(m_nApplied < m_nDepth) {
+		boundApply(m_nApplied);
+		m_nApplied++;
+	}
+
+	// Tasks the agent can't do keep their tail, the ones it can do lose it in every child but one
+	int d = m_nDepth;
+	int agent = m_vOrder[d];
+	double other = 1;
+	for(int t = 0; t < m_nM; t++) {
+		if(!m_pInput->iCanDoj(agent, t)) {
+			other *= m_vTail[t];
+		}
+	}
+	m_vOther[d] = other;
+
+	const std::vector<int>& canDo = CanDo(d);
+	for(unsigned int k = 0; k < canDo.size(); k++) {
+		int t = canDo[k];
+		m_vvWithout[d][k] = m_pPoissonB->TailWithout(m_pInput->get_d_j(t), m_vvPMF[t], m_pInput->get_p_ij(agent, t));
+	}
+}
+
+// Takes the agent at depth d off every task but its own in the bound, saving what changes on the trail
+void SearchEngine::boundApply(int d) {
+	int agent = m_vOrder[d];
+	int task = m_vTask[agent];
+	const std::vector<int>& canDo = CanDo(d);
+	for(unsigned int k = 0; k < canDo.size(); k++) {
+		int t = canDo[k];
+		if(t != task) {
+			std::vector<double>& pmf = m_vvPMF[t];
+			m_vvvTrail[d][k].assign(pmf.begin(), pmf.end());
+			m_vvTrailTail[d][k] = m_vTail[t];
+			m_pPoissonB->RemoveTrial(pmf, m_pInput->get_p_ij(agent, t));
+			m_vTail[t] = m_pPoissonB->Tail(m_pInput->get_d_j(t), pmf);
+		}
+	}
+}
+
+// Undoes boundApply(d) from the trail
+void SearchEngine::boundUndo(int d) {
+	int task = m_vTask[m_vOrder[d]];
+	const std::vector<int>& canDo = CanDo(d);
+	for(unsigned int k = 0; k < canDo.size(); k++) {
+		int t = canDo[k];
+		if(t != task) {
+			std::vector<double>& saved = m_vvvTrail[d][k];
+			m_vvPMF[t].assign(saved.begin(), saved.end());
+			m_vTail[t] = m_vvTrailTail[d][k];
+		}
+	}
+}
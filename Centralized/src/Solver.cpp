@@ -3,10 +3,83 @@
 using namespace std::complex_literals;
 
 Solver::Solver() {
+	m_fDeltaNonZeroProd = 1;
+	m_nDeltaZeroTasks = 0;
+	m_fDeltaZ = 0;
+	m_bHasDeadline = false;
+	m_pCancel = NULL;
+	m_bStopped = false;
+	m_nStopChecks = 0;
 }
 
 Solver::~Solver() {}
 
+/*
+ * Runs Solve() but stops once deadline passes or *cancel is set (cancel may be NULL).
+ * Solvers check for this at cheap points and then return their best incumbent in
+ * I_final. Pass Clock::time_point::max() for no deadline.
+ */
+SolveResult Solver::SolveWithin(MASPInput* input, I_solution* I_final, Clock::time_point deadline, std::atomic<bool>* cancel) {
+	m_bHasDeadline = (deadline != Clock::time_point::max());
+	m_deadline = deadline;
+	m_pCancel = cancel;
+	m_bStopped = false;
+	m_nStopChecks = 0;
+	m_stats.Reset();
+	m_poissonBinomial.ResetCalls();
+
+	Solve(input, I_final);
+
+	// Pick up the evaluations made through the shared Poisson-Binomial helper
+	m_stats.nPMFCalls += m_poissonBinomial.Calls();
+
+	SolveResult result;
+	result.bStopped = m_bStopped;
+	result.bOptimal = IsExact() && !m_bStopped;
+	result.fZ = I_final->BenchmarkClsdForm();
+
+	if(SANITY_PRINT && m_bStopped)
+		printf(" Solver stopped early, returning incumbent Z = %f\n", result.fZ);
+
+	// Later calls to Solve() run without limits
+	m_bHasDeadline = false;
+	m_pCancel = NULL;
+	m_bStopped = false;
+
+	return result;
+}
+
+/*
+ * Returns true once the deadline of SolveWithin() has passed or the solve was cancelled.
+ * Only reads the clock every STOP_CHECK_PERIOD calls so it can be called once per node.
+ */
+bool Solver::StopRequested() {
+	if(m_bStopped) {
+		return true;
+	}
+
+	if(m_pCancel != NULL && m_pCancel->load(std::memory_order_relaxed)) {
+		m_bStopped = true;
+	}
+	else if(m_bHasDeadline && (m_nStopChecks.fetch_add(1, std::memory_order_relaxed) % STOP_CHECK_PERIOD) == 0) {
+		m_bStopped = (Clock::now() >= m_deadline);
+	}
+
+	return m_bStopped;
+}
+
+/*
+ * Same as StopRequested() but reads the clock on every call, for check points that are
+ * far apart (e.g. the head of a loop whose body runs for a long time)
+ */
+bool Solver::DeadlinePassed() {
+	if(!m_bStopped && m_bHasDeadline && Clock::now() >= m_deadline) {
+		m_bStopped = true;
+	}
+
+	return StopRequested();
+}
+
 
 
 /*
@@ -58,6 +131,11 @@ double Solver::BenchmarkRec(MASPInput* input, bool** x_ij) {
  * and assignment I_sol. Assumes that I_sol contains a valid solution.
  */
 double Solver::BenchmarkCF(MASPInput* input, bool** x_ij) {
+	return BenchmarkCF(input, x_ij, m_poissonBinomial);
+}
+
+// Same as above but evaluates with poissonB, so search threads can each use their own
+double Solver::BenchmarkCF(MASPInput* input, bool** x_ij, PoissonBinomial& poissonB) {
 	// Sanity print
 	if(DEBUG_SOLVER) {
 		printf("Found Solution I: ");
@@ -103,7 +181,7 @@ double Solver::BenchmarkCF(MASPInput* input, bool** x_ij) {
 				printf(" * P_f(K=%d, I_%d)", k, j);
 
 			// PMF - Probability of getting k successes out of n trials
-			Ps += m_poissonBinomial.PMF(k, N_j, p_values);
+			Ps += poissonB.PMF(k, N_j, p_values);
 		}
 		if(DEBUG_SOLVER)
 			printf("}");
@@ -122,6 +200,125 @@ double Solver::BenchmarkCF(MASPInput* input, bool** x_ij) {
 	return prob_success;
 }
 
+/*
+ * Records the task of each agent in x_ij and caches the success-count PMF and P_s of
+ * every task so that single-agent moves can be evaluated with deltaZ().
+ */
+void Solver::InitDeltaCache(MASPInput* input, bool** x_ij) {
+	m_vDeltaTask.assign(input->getN(), -1);
+	m_vDeltaPMF.assign(input->getM(), std::vector<double>(1, 1.0));
+	m_vDeltaPs.assign(input->getM(), 0);
+
+	// Record who is assigned where
+	for(int i = 0; i < input->getN(); i++) {
+		for(int j = 0; j < input->getM(); j++) {
+			if(x_ij[i][j]) {
+				m_vDeltaTask.at(i) = j;
+				m_poissonBinomial.AddTrial(m_vDeltaPMF.at(j), input->get_p_ij(i,j));
+				break;
+			}
+		}
+	}
+
+	// Cache P_s for each task
+	for(int j = 0; j < input->getM(); j++) {
+		m_vDeltaPs.at(j) = m_poissonBinomial.Tail(input->get_d_j(j), m_vDeltaPMF.at(j));
+	}
+	updateDeltaZ();
+}
+
+/*
+ * Returns the change in Z from moving agent i from task from_j to task to_j. Only the two
+ * affected tasks are re-evaluated. Either task may be -1 (agent not assigned to anything).
+ */
+double Solver::deltaZ(MASPInput* input, int i, int from_j, int to_j) {
+	if(from_j == to_j) {
+		return 0;
+	}
+	m_stats.nCacheHits++;
+
+	// New P_s for the two affected tasks
+	double Ps_from = 1, Ps_to = 1;
+	// Old P_s for the two affected tasks
+	double old_from = 1, old_to = 1;
+	if(from_j >= 0) {
+		old_from = m_vDeltaPs.at(from_j);
+		Ps_from = PsWithout(input, i, from_j);
+	}
+	if(to_j >= 0) {
+		old_to = m_vDeltaPs.at(to_j);
+		Ps_to = PsWith(input, i, to_j);
+	}
+
+	// Product of every other task, found by factoring the two old values out of the cache
+	int zeros = m_nDeltaZeroTasks;
+	double others = m_fDeltaNonZeroProd;
+	if(old_from <= 0) {
+		zeros--;
+	}
+	else {
+		others /= old_from;
+	}
+	if(old_to <= 0) {
+		zeros--;
+	}
+	else {
+		others /= old_to;
+	}
+	if(zeros > 0) {
+		others = 0;
+	}
+
+	return others*Ps_from*Ps_to - m_fDeltaZ;
+}
+
+// Commits the move of agent i from task from_j to task to_j to the move cache
+void Solver::ApplyMove(MASPInput* input, int i, int from_j, int to_j) {
+	if(from_j == to_j) {
+		return;
+	}
+
+	if(from_j >= 0) {
+		m_poissonBinomial.RemoveTrial(m_vDeltaPMF.at(from_j), input->get_p_ij(i, from_j));
+		m_vDeltaPs.at(from_j) = m_poissonBinomial.Tail(input->get_d_j(from_j), m_vDeltaPMF.at(from_j));
+	}
+	if(to_j >= 0) {
+		m_poissonBinomial.AddTrial(m_vDeltaPMF.at(to_j), input->get_p_ij(i, to_j));
+		m_vDeltaPs.at(to_j) = m_poissonBinomial.Tail(input->get_d_j(to_j), m_vDeltaPMF.at(to_j));
+	}
+	m_vDeltaTask.at(i) = to_j;
+
+	updateDeltaZ();
+}
+
+// P_s of task j if agent i joined it
+double Solver::PsWith(MASPInput* input, int i, int j) {
+	m_stats.nCacheHits++;
+	return m_poissonBinomial.TailWith(input->get_d_j(j), m_vDeltaPMF.at(j), input->get_p_ij(i,j));
+}
+
+// P_s of task j if agent i left it
+double Solver::PsWithout(MASPInput* input, int i, int j) {
+	m_stats.nCacheHits++;
+	return m_poissonBinomial.TailWithout(input->get_d_j(j), m_vDeltaPMF.at(j), input->get_p_ij(i,j));
+}
+
+// Re-computes the cached Z from the cached P_s values
+void Solver::updateDeltaZ() {
+	m_fDeltaNonZeroProd = 1;
+	m_nDeltaZeroTasks = 0;
+	for(double Ps : m_vDeltaPs) {
+		if(Ps <= 0) {
+			m_nDeltaZeroTasks++;
+		}
+		else {
+			m_fDeltaNonZeroProd *= Ps;
+		}
+	}
+
+	m_fDeltaZ = (m_nDeltaZeroTasks > 0) ? 0 : m_fDeltaNonZeroProd;
+}
+
 bool Solver::wholeNumber(double f) {
 	double diff = f-floor(f);
 	if(diff >= 0) {
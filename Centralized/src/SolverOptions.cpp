@@ -0,0 +1,263 @@
+#include "SolverOptions.h"
+#include "Hungarian.h"
+#include "MinCostFlow.h"
+#include "LagrangianBound.h"
+#include "SearchEngine.h"
+
+SolverOptions::SolverOptions() {
+	fTimeLimit = 0;
+	nThreads = 1;
+	nSeed = time(NULL);
+	bSortAgents = true;
+	nVarOrder = e_VarOrder_Static;
+	nValueOrder = e_ValueOrder_Index;
+	bPruning = true;
+	bSymmetry = false;
+	fSymmetryTol = 0;
+	bHeuristicStart = true;
+	bBestImprovement = false;
+	bRematch = false;
+	nAssignment = e_Assign_Munkres;
+	nMatching = e_Match_Flow;
+	nBound = e_Bound_Optimistic;
+	nSearch = e_Search_DepthFirst;
+	fFrontierMB = 256;
+	fGap = 0;
+	fGapReport = 0;
+	sCheckpoint = "";
+	fCheckpointEvery = 60;
+	bResume = false;
+	bDominance = false;
+	fTableMB = 64;
+	bPropagate = false;
+}
+
+/*
+ * Parses every --name=value argument in argv into this object. Arguments that do not
+ * start with "--" are returned in positional (argv[0] excluded). Returns false and
+ * prints the problem if an option is unknown or has a bad value.
+ */
+bool SolverOptions::Parse(int argc, char* argv[], std::vector<std::string>& positional) {
+	for(int a = 1; a < argc; a++) {
+		std::string arg(argv[a]);
+
+		// Positional argument?
+		if(arg.compare(0, 2, "--") != 0) {
+			positional.push_back(arg);
+			continue;
+		}
+
+		// Split into name and value, a bare flag means "true"
+		std::string name = arg.substr(2);
+		std::string value = "1";
+		size_t eq = name.find('=');
+		if(eq != std::string::npos) {
+			value = name.substr(eq + 1);
+			name = name.substr(0, eq);
+		}
+
+		if(DEBUG_SOLVEROPTS)
+			printf("Option: %s = %s\n", name.c_str(), value.c_str());
+
+		bool good = true;
+		if(name == "time-limit") {
+			fTimeLimit = atof(value.c_str());
+			good = fTimeLimit >= 0;
+		}
+		else if(name == "threads") {
+			nThreads = atoi(value.c_str());
+			good = nThreads >= 1;
+		}
+		else if(name == "seed") {
+			nSeed = strtoul(value.c_str(), NULL, 10);
+		}
+		else if(name == "sort-agents") {
+			good = parseBool(value, &bSortAgents);
+		}
+		else if(name == "var-order") {
+			if(value == "static") {
+				nVarOrder = e_VarOrder_Static;
+			}
+			else if(value == "dynamic") {
+				nVarOrder = e_VarOrder_Dynamic;
+			}
+			else {
+				good = false;
+			}
+		}
+		else if(name == "value-order") {
+			if(value == "index") {
+				nValueOrder = e_ValueOrder_Index;
+			}
+			else if(value == "gain") {
+				nValueOrder = e_ValueOrder_Gain;
+			}
+			else {
+				good = false;
+			}
+		}
+		else if(name == "pruning") {
+			good = parseBool(value, &bPruning);
+		}
+		else if(name == "symmetry") {
+			good = parseBool(value, &bSymmetry);
+		}
+		else if(name == "symmetry-tol") {
+			fSymmetryTol = atof(value.c_str());
+			good = fSymmetryTol >= 0;
+		}
+		else if(name == "heuristic-start") {
+			good = parseBool(value, &bHeuristicStart);
+		}
+		else if(name == "best-improvement") {
+			good = parseBool(value, &bBestImprovement);
+		}
+		else if(name == "rematch") {
+			good = parseBool(value, &bRematch);
+		}
+		else if(name == "assignment") {
+			if(value == "munkres") {
+				nAssignment = e_Assign_Munkres;
+			}
+			else if(value == "lapjv") {
+				nAssignment = e_Assign_LAPJV;
+			}
+			else if(value == "auction") {
+				nAssignment = e_Assign_Auction;
+			}
+			else if(value == "sparse") {
+				nAssignment = e_Assign_Sparse;
+			}
+			else {
+				good = false;
+			}
+		}
+		else if(name == "bound") {
+			if(value == "optimistic") {
+				nBound = e_Bound_Optimistic;
+			}
+			else if(value == "lagrangian") {
+				nBound = e_Bound_Lagrangian;
+			}
+			else {
+				good = false;
+			}
+		}
+		else if(name == "search") {
+			if(value == "dfs") {
+				nSearch = e_Search_DepthFirst;
+			}
+			else if(value == "best-first") {
+				nSearch = e_Search_BestFirst;
+			}
+			else {
+				good = false;
+			}
+		}
+		else if(name == "frontier-mb") {
+			fFrontierMB = atof(value.c_str());
+			good = fFrontierMB >= 0;
+		}
+		else if(name == "gap") {
+			fGap = atof(value.c_str());
+			good = fGap >= 0 && fGap <= 1;
+		}
+		else if(name == "gap-report") {
+			fGapReport = atof(value.c_str());
+			good = fGapReport >= 0;
+		}
+		else if(name == "checkpoint") {
+			sCheckpoint = value;
+			good = !sCheckpoint.empty();
+		}
+		else if(name == "checkpoint-every") {
+			fCheckpointEvery = atof(value.c_str());
+			good = fCheckpointEvery > 0;
+		}
+		else if(name == "resume") {
+			good = parseBool(value, &bResume);
+		}
+		else if(name == "dominance") {
+			good = parseBool(value, &bDominance);
+		}
+		else if(name == "tt-mb") {
+			fTableMB = atof(value.c_str());
+			good = fTableMB > 0;
+		}
+		else if(name == "propagate") {
+			good = parseBool(value, &bPropagate);
+		}
+		else if(name == "matching") {
+			if(value == "flow") {
+				nMatching = e_Match_Flow;
+			}
+			else if(value == "matrix") {
+				nMatching = e_Match_Matrix;
+			}
+			else {
+				good = false;
+			}
+		}
+		else {
+			fprintf(stderr, "[ERROR][SolverOptions::Parse] : Unknown option \"--%s\"\n", name.c_str());
+			return false;
+		}
+
+		if(!good) {
+			fprintf(stderr, "[ERROR][SolverOptions::Parse] : Bad value \"%s\" for option \"--%s\"\n", value.c_str(), name.c_str());
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Prints the available options
+void SolverOptions::PrintUsage(FILE* stream) {
+	fprintf(stream, "Options:\n");
+	fprintf(stream, "  --time-limit=<s>          wall-clock limit for the solve in seconds (0 = none)\n");
+	fprintf(stream, "  --threads=<n>             number of worker threads (parallel bnm search, auction bidders)\n");
+	fprintf(stream, "  --seed=<n>                random seed (default: current time)\n");
+	fprintf(stream, "  --sort-agents=<0|1>       sort agents by branching factor in exact solvers\n");
+	fprintf(stream, "  --var-order=<order>       agent order of exact solvers: static (default) or dynamic (most constrained first)\n");
+	fprintf(stream, "  --value-order=<order>     task order of exact solvers: index (default) or gain (optimistic bound gain first)\n");
+	fprintf(stream, "  --pruning=<0|1>           prune by bound in exact solvers\n");
+	fprintf(stream, "  --symmetry=<0|1>          treat agents with equal capabilities and p_ij as interchangeable in exact solvers\n");
+	fprintf(stream, "  --symmetry-tol=<x>        largest p_ij difference between interchangeable agents (default 0)\n");
+	fprintf(stream, "  --heuristic-start=<0|1>   seed exact solvers with a heuristic solution\n");
+	fprintf(stream, "  --best-improvement=<0|1>  best-improvement local search in gradient heuristics\n");
+	fprintf(stream, "  --rematch=<0|1>           match-gs: re-match with each agent kept off its task, then descend again\n");
+	fprintf(stream, "  --assignment=<alg>        assignment solver for matching: munkres (default), lapjv, auction or sparse\n");
+	fprintf(stream, "  --matching=<alg>          balanced matching: flow (min-cost flow, default) or matrix (expanded assignment)\n");
+	fprintf(stream, "  --bound=<alg>             bnm pruning bound: optimistic (default) or lagrangian\n");
+	fprintf(stream, "  --search=<order>          bnm node order: dfs (default) or best-first (highest bound first)\n");
+	fprintf(stream, "  --frontier-mb=<MB>        memory cap on the best-first open nodes, then depth-first (default 256)\n");
+	fprintf(stream, "  --gap=<x>                 stop best-first bnm once (bound - incumbent)/bound <= x (default 0)\n");
+	fprintf(stream, "  --gap-report=<s>          print the best-first bnm bound, incumbent and gap every s seconds (0 = never)\n");
+	fprintf(stream, "  --checkpoint=<file>       save the state of a depth-first bnm search to file (on stop and periodically)\n");
+	fprintf(stream, "  --checkpoint-every=<s>    seconds between checkpoints (default 60)\n");
+	fprintf(stream, "  --resume=<0|1>            continue the search saved in the --checkpoint file if it exists\n");
+	fprintf(stream, "  --dominance=<0|1>         prune fast-comp/bnm states dominated by a searched state with the same agents left\n");
+	fprintf(stream, "  --tt-mb=<MB>              memory of the dominance table (default 64)\n");
+	fprintf(stream, "  --propagate=<0|1>         apply forced moves and detect dead ends at each node of exact solvers\n");
+}
+
+// Prints the options that are currently set
+void SolverOptions::Print(FILE* stream) {
+	fprintf(stream, "time-limit=%f threads=%d seed=%u sort-agents=%d var-order=%d value-order=%d pruning=%d symmetry=%d symmetry-tol=%f heuristic-start=%d best-improvement=%d rematch=%d assignment=%d matching=%d bound=%d search=%d frontier-mb=%f gap=%f gap-report=%f checkpoint=%s checkpoint-every=%f resume=%d dominance=%d tt-mb=%f propagate=%d\n",
+			fTimeLimit, nThreads, nSeed, bSortAgents, nVarOrder, nValueOrder, bPruning, bSymmetry, fSymmetryTol, bHeuristicStart, bBestImprovement, bRematch, nAssignment, nMatching, nBound, nSearch, fFrontierMB, fGap, fGapReport, sCheckpoint.c_str(), fCheckpointEvery, bResume, bDominance, fTableMB, bPropagate);
+}
+
+// Parses a true/false value, accepts 0/1/true/false
+bool SolverOptions::parseBool(const std::string& value, bool* out) {
+	if(value == "1" || value == "true") {
+		*out = true;
+		return true;
+	}
+	else if(value == "0" || value == "false") {
+		*out = false;
+		return true;
+	}
+
+	return false;
+}
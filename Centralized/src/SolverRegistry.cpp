@@ -0,0 +1,68 @@
+#include "SolverRegistry.h"
+
+// Gets the one registry shared by all solvers
+SolverRegistry& SolverRegistry::Instance() {
+	static SolverRegistry registry;
+	return registry;
+}
+
+// Adds a solver. Returns true so that it can be used to initialize a static.
+bool SolverRegistry::Register(int id, const char* name, Factory factory) {
+	for(Entry_t& entry : m_vEntries) {
+		if(entry.id == id || entry.name == name) {
+			fprintf(stderr, "[ERROR][SolverRegistry::Register] : Solver %d (%s) registered twice\n", id, name);
+			exit(1);
+		}
+	}
+
+	if(DEBUG_SOLVERREG)
+		printf("Registered solver %d: %s\n", id, name);
+
+	Entry_t entry = {id, std::string(name), factory};
+	auto it = m_vEntries.begin();
+	while(it != m_vEntries.end() && it->id < id) {
+		it++;
+	}
+	m_vEntries.insert(it, entry);
+
+	return true;
+}
+
+// Creates solver id, returns NULL if there is no such solver
+Solver* SolverRegistry::Create(int id) {
+	for(Entry_t& entry : m_vEntries) {
+		if(entry.id == id) {
+			return entry.factory();
+		}
+	}
+
+	return NULL;
+}
+
+/*
+ * Creates a solver from either its identifier or its name. Returns NULL if there is
+ * no such solver, otherwise *id is set to the solver's identifier.
+ */
+Solver* SolverRegistry::Create(const std::string& key, int* id) {
+	// Numeric identifier?
+	char* end = NULL;
+	long num = strtol(key.c_str(), &end, 10);
+	bool numeric = !key.empty() && *end == '\0';
+
+	for(Entry_t& entry : m_vEntries) {
+		if((numeric && entry.id == num) || (!numeric && entry.name == key)) {
+			*id = entry.id;
+			return entry.factory();
+		}
+	}
+
+	return NULL;
+}
+
+// Prints all registered solvers
+void SolverRegistry::PrintSolvers(FILE* stream) {
+	fprintf(stream, "Algorithms:\n");
+	for(Entry_t& entry : m_vEntries) {
+		fprintf(stream, "  %2d  %s\n", entry.id, entry.name.c_str());
+	}
+}
@@ -0,0 +1,55 @@
+#include "SolverStats.h"
+
+#include <algorithm>
+
+// Sets all counters to 0
+void SolverStats::Reset() {
+	nNodes = 0;
+	nPruneRequirements = 0;
+	nPruneBound = 0;
+	nPruneMatching = 0;
+	nLeaves = 0;
+	nInvalidLeaves = 0;
+	nPMFCalls = 0;
+	nHungarianCalls = 0;
+	fAssignmentTime = 0;
+	nCacheHits = 0;
+	nPruneDominance = 0;
+	nForced = 0;
+	nPrunePropagation = 0;
+	nAuctionRounds = 0;
+	fAuctionEpsilon = 0;
+	fAuctionGap = 0;
+}
+
+// Adds the counters of other (epsilon and gap take the larger), used to merge the counters of search threads
+void SolverStats::Add(const SolverStats& other) {
+	nNodes += other.nNodes;
+	nPruneRequirements += other.nPruneRequirements;
+	nPruneBound += other.nPruneBound;
+	nPruneMatching += other.nPruneMatching;
+	nLeaves += other.nLeaves;
+	nInvalidLeaves += other.nInvalidLeaves;
+	nPMFCalls += other.nPMFCalls;
+	nHungarianCalls += other.nHungarianCalls;
+	fAssignmentTime += other.fAssignmentTime;
+	nCacheHits += other.nCacheHits;
+	nPruneDominance += other.nPruneDominance;
+	nForced += other.nForced;
+	nPrunePropagation += other.nPrunePropagation;
+	nAuctionRounds += other.nAuctionRounds;
+	fAuctionEpsilon = std::max(fAuctionEpsilon, other.fAuctionEpsilon);
+	fAuctionGap = std::max(fAuctionGap, other.fAuctionGap);
+}
+
+// Prints the counters on one line, in the order of PrintHeader()
+void SolverStats::Print(FILE* stream) const {
+	fprintf(stream, "%ld %ld %ld %ld %ld %ld %ld %ld %f %ld %ld %ld %ld %ld %g %g", nNodes, nPruneRequirements, nPruneBound, nPruneMatching,
+			nLeaves, nInvalidLeaves, nPMFCalls, nHungarianCalls, fAssignmentTime, nCacheHits, nPruneDominance,
+			nForced, nPrunePropagation, nAuctionRounds, fAuctionEpsilon, fAuctionGap);
+}
+
+// Prints the names of the counters on one line
+void SolverStats::PrintHeader(FILE* stream) {
+	fprintf(stream, "nodes prune_req prune_bound prune_match leaves invalid pmf_calls hungarian_calls assignment_time cache_hits prune_dom forced prune_prop auction_rounds auction_eps auction_gap");
+}
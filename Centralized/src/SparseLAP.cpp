@@ -0,0 +1,188 @@
+#include "SparseLAP.h"
+
+SparseLAP::SparseLAP() {
+	m_nSearch = 0;
+}
+
+SparseLAP::~SparseLAP() {}
+
+/*
+ * Minimizes the cost of assigning each of the nRows rows to a unique column, using only
+ * the given edges (nRows <= nCols). Assignment[row] is set to the assigned column and
+ * *cost to the total cost. Returns false if some row cannot be assigned.
+ */
+bool SparseLAP::Solve(int nRows, int nCols, const std::vector<SparseEdge_t>& edges, std::vector<int>& Assignment, double* cost) {
+	Assignment.assign(nRows, -1);
+	*cost = 0;
+	if(nRows > nCols) {
+		return false;
+	}
+
+	// Bucket the edges by row
+	m_vRowStart.assign(nRows + 1, 0);
+	for(const SparseEdge_t& edge : edges) {
+		m_vRowStart[edge.row + 1]++;
+	}
+	for(int i = 0; i < nRows; i++) {
+		m_vRowStart[i + 1] += m_vRowStart[i];
+	}
+	m_vCol.resize(edges.size());
+	m_vCost.resize(edges.size());
+	m_vPred.assign(nRows, 0);
+	for(const SparseEdge_t& edge : edges) {
+		int e = m_vRowStart[edge.row] + m_vPred[edge.row]++;
+		m_vCol[e] = edge.col;
+		m_vCost[e] = edge.cost;
+	}
+
+	m_vU.assign(nRows, 0.0);
+	m_vV.assign(nCols, 0.0);
+	m_vRowSol.assign(nRows, -1);
+	m_vColSol.assign(nCols, -1);
+	m_vDist.assign(nCols, 0.0);
+	m_vPred.assign(nCols, -1);
+	m_vStamp.assign(nCols, -1);
+	m_vSettled.assign(nCols, false);
+	m_nSearch = 0;
+
+	for(int i = 0; i < nRows; i++) {
+		if(!augment(i)) {
+			if(DEBUG_SPARSELAP)
+				printf("SparseLAP: row %d cannot be assigned\n", i);
+			return false;
+		}
+	}
+
+	for(int i = 0; i < nRows; i++) {
+		// Cheapest edge to the assigned column, in case of parallel edges
+		double edgeCost = std::numeric_limits<double>::infinity();
+		for(int e = m_vRowStart[i]; e < m_vRowStart[i + 1]; e++) {
+			if(m_vCol[e] == m_vRowSol[i]) {
+				edgeCost = std::min(edgeCost, m_vCost[e]);
+			}
+		}
+		Assignment[i] = m_vRowSol[i];
+		*cost += edgeCost;
+	}
+
+	if(DEBUG_SPARSELAP)
+		printf("SparseLAP: %d x %d, %ld edges, cost = %f\n", nRows, nCols, edges.size(), *cost);
+
+	return true;
+}
+
+// Same as above on a dense matrix, entries >= INF are left out
+bool SparseLAP::Solve(std::vector<std::vector<double>>& DistMatrix, std::vector<int>& Assignment, double* cost) {
+	int nRows = DistMatrix.size();
+	int nCols = (nRows > 0) ? DistMatrix[0].size() : 0;
+
+	m_vEdges.clear();
+	for(int i = 0; i < nRows; i++) {
+		for(int j = 0; j < nCols; j++) {
+			if(DistMatrix[i][j] < INF) {
+				m_vEdges.push_back({i, j, DistMatrix[i][j]});
+			}
+		}
+	}
+
+	return Solve(nRows, nCols, m_vEdges, Assignment, cost);
+}
+
+// Same as above on an nRows x nCols row-major matrix
+bool SparseLAP::Solve(const double* CostMatrix, int nRows, int nCols, std::vector<int>& Assignment, double* cost) {
+	m_vEdges.clear();
+	for(int i = 0; i < nRows; i++) {
+		for(int j = 0; j < nCols; j++) {
+			if(CostMatrix[(size_t)i*nCols + j] < INF) {
+				m_vEdges.push_back({i, j, CostMatrix[(size_t)i*nCols + j]});
+			}
+		}
+	}
+
+	return Solve(nRows, nCols, m_vEdges, Assignment, cost);
+}
+
+// Matches free row s along a shortest augmenting path, updating the duals. Returns false if no free column is reachable
+bool SparseLAP::augment(int s) {
+	typedef std::pair<double, int> Entry;
+	if(m_vRowStart[s] == m_vRowStart[s + 1]) {
+		return false;
+	}
+
+	// Start s at its cheapest reduced cost so that none of its edges are negative
+	double minReduced = std::numeric_limits<double>::infinity();
+	for(int e = m_vRowStart[s]; e < m_vRowStart[s + 1]; e++) {
+		minReduced = std::min(minReduced, m_vCost[e] - m_vV[m_vCol[e]]);
+	}
+	m_vU[s] = minReduced;
+
+	m_nSearch++;
+	m_vSettledList.clear();
+	std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> heap;
+
+	// Relaxes the edges of row i, reached at distance base
+	auto relax = [&](int i, double base) {
+		for(int e = m_vRowStart[i]; e < m_vRowStart[i + 1]; e++) {
+			int j = m_vCol[e];
+			if(m_vStamp[j] == m_nSearch && m_vSettled[j]) {
+				continue;
+			}
+			double dist = base + std::max(0.0, m_vCost[e] - m_vU[i] - m_vV[j]);
+			if(m_vStamp[j] != m_nSearch || dist < m_vDist[j]) {
+				m_vStamp[j] = m_nSearch;
+				m_vSettled[j] = false;
+				m_vDist[j] = dist;
+				m_vPred[j] = i;
+				heap.push(Entry(dist, j));
+			}
+		}
+	};
+
+	relax(s, 0);
+	int end = -1;
+	while(!heap.empty()) {
+		Entry top = heap.top();
+		heap.pop();
+		int j = top.second;
+		if(m_vSettled[j] || top.first > m_vDist[j]) {
+			continue;
+		}
+		m_vSettled[j] = true;
+		m_vSettledList.push_back(j);
+
+		if(m_vColSol[j] < 0) {
+			end = j;
+			break;
+		}
+		relax(m_vColSol[j], m_vDist[j]);
+	}
+
+	if(end < 0) {
+		return false;
+	}
+
+	// Shift the duals of everything settled so the path becomes tight
+	double D = m_vDist[end];
+	for(int j : m_vSettledList) {
+		if(j != end) {
+			m_vV[j] -= D - m_vDist[j];
+			m_vU[m_vColSol[j]] += D - m_vDist[j];
+		}
+	}
+	m_vU[s] += D;
+
+	// Flip the matching along the path
+	int j = end;
+	while(true) {
+		int i = m_vPred[j];
+		int next = m_vRowSol[i];
+		m_vRowSol[i] = j;
+		m_vColSol[j] = i;
+		if(i == s) {
+			break;
+		}
+		j = next;
+	}
+
+	return true;
+}
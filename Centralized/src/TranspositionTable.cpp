@@ -0,0 +1,164 @@
+#include "TranspositionTable.h"
+
+TranspositionTable::TranspositionTable() {
+	m_pInput = NULL;
+	m_nSurvival = 0;
+	m_nBuckets = 0;
+	m_nGroup = 0;
+	m_nState = 0;
+}
+
+TranspositionTable::~TranspositionTable() {}
+
+// Sizes the table for input to at most megabytes, agents with the same agentClass[i] are interchangeable
+void TranspositionTable::Init(MASPInput* input, double megabytes, const std::vector<int>& agentClass) {
+	m_pInput = input;
+	int M = input->getM();
+	m_vClass = agentClass;
+	int classes = 0;
+	for(int c : agentClass) {
+		classes = std::max(classes, c + 1);
+	}
+
+	// Fixed seed, runs should not depend on the hash keys
+	std::mt19937_64 rng(0x9E3779B97F4A7C15ULL);
+	m_vClassKey.resize(classes);
+	m_vvTaskKey.assign(classes, std::vector<uint64_t>(M));
+	for(int c = 0; c < classes; c++) {
+		m_vClassKey[c] = rng();
+		for(int j = 0; j < M; j++) {
+			m_vvTaskKey[c][j] = rng();
+		}
+	}
+
+	m_nSurvival = 0;
+	m_vOffset.resize(M);
+	for(int j = 0; j < M; j++) {
+		m_vOffset[j] = m_nSurvival;
+		m_nSurvival += input->get_d_j(j);
+	}
+	m_vWork.assign(m_nSurvival, 0);
+	m_vPMF.assign(m_nSurvival, 0);
+
+	// Two hashes, the survival values and a used flag per slot
+	double slotBytes = 2*sizeof(uint64_t) + m_nSurvival*sizeof(double) + 1;
+	m_nBuckets = std::max(1.0, megabytes*1024*1024/(TT_BUCKET_SLOTS*slotBytes));
+	m_pGroup.reset(new uint64_t[m_nBuckets*TT_BUCKET_SLOTS]);
+	m_pState.reset(new uint64_t[m_nBuckets*TT_BUCKET_SLOTS]);
+	m_pSurvival.reset(new double[m_nBuckets*TT_BUCKET_SLOTS*m_nSurvival]);
+	m_vUsed.assign(m_nBuckets*TT_BUCKET_SLOTS, false);
+	m_vNext.assign(m_nBuckets, 0);
+
+	if(DEBUG_TT)
+		printf("Transposition table: %zu buckets of %d slots, %d survival values per slot\n", m_nBuckets, TT_BUCKET_SLOTS, m_nSurvival);
+}
+
+/*
+ * Is the current state of engine a transposition of a stored state, or dominated by
+ * one with the same agents left? Leaves the hashes and survival values of the state in
+ * the workspace for Store().
+ */
+bool TranspositionTable::Dominated(SearchEngine& engine) {
+	int N = m_pInput->getN();
+	int M = m_pInput->getM();
+
+	// Hashes and the PMF of the successes on each task (only the first d_j terms are needed)
+	std::fill(m_vPMF.begin(), m_vPMF.end(), 0);
+	for(int j = 0; j < M; j++) {
+		if(m_pInput->get_d_j(j) > 0) {
+			m_vPMF[m_vOffset[j]] = 1;
+		}
+	}
+	m_nGroup = 0;
+	m_nState = 0;
+	for(int a = 0; a < N; a++) {
+		int j = engine.Task(a);
+		if(j < 0) {
+			continue;
+		}
+		m_nGroup += m_vClassKey[m_vClass[a]];
+		m_nState += m_vvTaskKey[m_vClass[a]][j];
+
+		int d_j = m_pInput->get_d_j(j);
+		if(d_j > 0) {
+			double* pmf = &m_vPMF[m_vOffset[j]];
+			double p = m_pInput->get_p_ij(a, j);
+			for(int m = d_j - 1; m > 0; m--) {
+				pmf[m] = pmf[m]*(1 - p) + pmf[m - 1]*p;
+			}
+			pmf[0] *= 1 - p;
+		}
+	}
+
+	// Survival P(X_j >= k) for k = 1..d_j
+	for(int j = 0; j < M; j++) {
+		int offset = m_vOffset[j];
+		double below = 0;
+		for(int k = 0; k < m_pInput->get_d_j(j); k++) {
+			below += m_vPMF[offset + k];
+			m_vWork[offset + k] = 1 - below;
+		}
+	}
+
+	size_t bucket = m_nGroup % m_nBuckets;
+	for(int s = 0; s < TT_BUCKET_SLOTS; s++) {
+		size_t slot = bucket*TT_BUCKET_SLOTS + s;
+		if(m_vUsed[slot] && m_pGroup[slot] == m_nGroup) {
+			if(m_pState[slot] == m_nState || dominates(slot, false)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/*
+ * Stores the state last passed to Dominated(). The solver must search its whole subtree
+ * before looking up any state that it could prune (always true in a serial depth-first
+ * search, as those have other agents left than the states below it).
+ */
+void TranspositionTable::Store() {
+	size_t bucket = m_nGroup % m_nBuckets;
+
+	// An empty slot, else one this state dominates, else the oldest
+	int pick = -1;
+	for(int s = 0; s < TT_BUCKET_SLOTS && pick < 0; s++) {
+		if(!m_vUsed[bucket*TT_BUCKET_SLOTS + s]) {
+			pick = s;
+		}
+	}
+	for(int s = 0; s < TT_BUCKET_SLOTS && pick < 0; s++) {
+		size_t slot = bucket*TT_BUCKET_SLOTS + s;
+		if(m_pGroup[slot] == m_nGroup && dominates(slot, true)) {
+			pick = s;
+		}
+	}
+	if(pick < 0) {
+		pick = m_vNext[bucket];
+		m_vNext[bucket] = (m_vNext[bucket] + 1) % TT_BUCKET_SLOTS;
+	}
+
+	size_t slot = bucket*TT_BUCKET_SLOTS + pick;
+	m_vUsed[slot] = true;
+	m_pGroup[slot] = m_nGroup;
+	m_pState[slot] = m_nState;
+	std::copy(m_vWork.begin(), m_vWork.end(), &m_pSurvival[slot*m_nSurvival]);
+}
+
+// Empties the table
+void TranspositionTable::Clear() {
+	std::fill(m_vUsed.begin(), m_vUsed.end(), false);
+	std::fill(m_vNext.begin(), m_vNext.end(), 0);
+}
+
+// Does the entry at slot dominate the workspace state (or, with reverse, is it dominated by it)?
+bool TranspositionTable::dominates(size_t slot, bool reverse) {
+	const double* stored = &m_pSurvival[slot*m_nSurvival];
+	for(int k = 0; k < m_nSurvival; k++) {
+		if(reverse ? (m_vWork[k] < stored[k]) : (stored[k] < m_vWork[k])) {
+			return false;
+		}
+	}
+	return true;
+}
@@ -0,0 +1,105 @@
+#include "WorkStealingPool.h"
+
+WorkStealingPool::WorkStealingPool() {
+	m_nPending = 0;
+	m_nIdle = 0;
+	m_nExecuted = 0;
+	m_nSteals = 0;
+}
+
+WorkStealingPool::~WorkStealingPool() {}
+
+// Empties the pool and sets up deques for nThreads threads
+void WorkStealingPool::Reset(int nThreads) {
+	if(nThreads < 1) {
+		fprintf(stderr, "[ERROR][WorkStealingPool::Reset] : Bad number of threads = %d\n", nThreads);
+		exit(1);
+	}
+
+	m_vDeques.clear();
+	for(int t = 0; t < nThreads; t++) {
+		m_vDeques.push_back(std::unique_ptr<Deque_t>(new Deque_t));
+	}
+	m_nPending = 0;
+	m_nIdle = 0;
+	m_nExecuted = 0;
+	m_nSteals = 0;
+}
+
+// Adds task to the back of thread t's deque, may be called from a running task
+void WorkStealingPool::Push(int t, Task task) {
+	m_nPending.fetch_add(1);
+	Deque_t& deque = *m_vDeques.at(t);
+	std::lock_guard<std::mutex> lock(deque.mutex);
+	deque.tasks.push_back(std::move(task));
+}
+
+// Runs the tasks on the threads of the pool, the calling thread is thread 0
+void WorkStealingPool::Run() {
+	std::vector<std::thread> workers;
+	for(int t = 1; t < Threads(); t++) {
+		workers.push_back(std::thread(&WorkStealingPool::workerLoop, this, t));
+	}
+	workerLoop(0);
+	for(std::thread& worker : workers) {
+		worker.join();
+	}
+
+	if(DEBUG_WSPOOL)
+		printf("WorkStealingPool: %d threads, %ld tasks, %ld steals\n", Threads(), m_nExecuted.load(), m_nSteals.load());
+}
+
+// Takes a task from the back of thread t's own deque
+bool WorkStealingPool::pop(int t, Task& task) {
+	Deque_t& deque = *m_vDeques.at(t);
+	std::lock_guard<std::mutex> lock(deque.mutex);
+	if(deque.tasks.empty()) {
+		return false;
+	}
+	task = std::move(deque.tasks.back());
+	deque.tasks.pop_back();
+	return true;
+}
+
+// Takes a task from the front of some other thread's deque
+bool WorkStealingPool::steal(int t, Task& task) {
+	for(int k = 1; k < Threads(); k++) {
+		Deque_t& deque = *m_vDeques.at((t + k) % Threads());
+		std::lock_guard<std::mutex> lock(deque.mutex);
+		if(!deque.tasks.empty()) {
+			task = std::move(deque.tasks.front());
+			deque.tasks.pop_front();
+			m_nSteals.fetch_add(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void WorkStealingPool::workerLoop(int t) {
+	Task task;
+	bool idle = false;
+	while(m_nPending.load() > 0) {
+		if(pop(t, task) || steal(t, task)) {
+			if(idle) {
+				m_nIdle.fetch_sub(1);
+				idle = false;
+			}
+			task(t);
+			task = nullptr;
+			m_nExecuted.fetch_add(1, std::memory_order_relaxed);
+			m_nPending.fetch_sub(1);
+		}
+		else {
+			// Nothing to do until a running task pushes more work
+			if(!idle) {
+				m_nIdle.fetch_add(1);
+				idle = true;
+			}
+			std::this_thread::yield();
+		}
+	}
+	if(idle) {
+		m_nIdle.fetch_sub(1);
+	}
+}
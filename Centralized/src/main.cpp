@@ -5,20 +5,9 @@
 
 #include "defines.h"
 #include "MASPInput.h"
-#include "MASP_comp.h"
-#include "MASP_FastComp.h"
-#include "MASP_BalMatch.h"
-#include "MASP_TMatch.h"
 #include "I_solution.h"
-#include "MASP_MatchAct.h"
-#include "MASP_EdgeCutting.h"
-#include "MASP_GradientSearch.h"
-#include "MASP_MatchGS.h"
-#include "MASP_MinDist.h"
-#include "MASP_LogBalMatch.h"
-#include "MASP_Swap.h"
-#include "MASP_BranchAndMatch.h"
-#include "MASP_BranchAndBound.h"
+#include "SolverOptions.h"
+#include "SolverRegistry.h"
 
 
 
@@ -32,132 +21,60 @@
 
 
 int main(int argc, char *argv[]) {
-	srand(time(NULL));
-
-	int algorithm = 3;
-	bool printResults;
-	const char* outputPath;
+	SolverOptions options;
+	std::vector<std::string> args;
+	std::string algorithm = "3";
+	int algorithmID = e_Algo_MASP_BMTCH;
+	bool printResults = PRINT_RESULTS;
+	const char* outputPath = DATA_LOG_DEFLT_PATH;
 	int runnum = 0;
 
 	// Verify user input
-	if(argc == 3) {
-		algorithm = atoi(argv[2]);
-		printResults = PRINT_RESULTS;
-		outputPath = DATA_LOG_DEFLT_PATH;
-	}
-	else if(argc == 4) {
-		algorithm = atoi(argv[2]);
-		printResults = atoi(argv[3]);
-		outputPath = DATA_LOG_DEFLT_PATH;
-	}
-	else if(argc == 5) {
-		algorithm = atoi(argv[2]);
-		printResults = atoi(argv[3]);
-		outputPath = argv[4];
-	}
-	else if(argc == 6) {
-		algorithm = atoi(argv[2]);
-		printResults = atoi(argv[3]);
-		outputPath = argv[4];
-		runnum = atoi(argv[5]);
-	}
-	else {
-		printf("Received %d args, expected 1 or more.\nExpected use:\t./find-assignment <file path> [algorithm] [print results] [output path] [run number]\n\n", argc - 1);
+	if(!options.Parse(argc, argv, args) || args.size() < 1 || args.size() > 5) {
+		printf("Received %d args, expected 1 or more.\nExpected use:\t./find-assignment <file path> [algorithm] [print results] [output path] [run number] [options]\n\n", argc - 1);
+		SolverRegistry::Instance().PrintSolvers(stdout);
+		SolverOptions::PrintUsage(stdout);
 		return 1;
 	}
-
-	Solver* solver = NULL;
-	MASPInput input(argv[1]);
-	I_solution solution(&input);
-
-	// Capture start time
-	auto start = std::chrono::high_resolution_clock::now();
-
-	switch(algorithm) {
-	case e_Algo_MASP_COMP: {
-		solver = new MASPComp();
-		solver->Solve(&input, &solution);
+	if(args.size() >= 2) {
+		algorithm = args.at(1);
 	}
-	break;
-
-	case e_Algo_MASP_FAST_COMP: {
-		solver = new MASP_FastComp();
-		solver->Solve(&input, &solution);
+	if(args.size() >= 3) {
+		printResults = atoi(args.at(2).c_str());
 	}
-	break;
-
-	case e_Algo_MASP_TMTCH: {
-		solver = new MASP_TMatch();
-		solver->Solve(&input, &solution);
+	if(args.size() >= 4) {
+		outputPath = args.at(3).c_str();
 	}
-	break;
-
-	case e_Algo_MASP_BMTCH: {
-		solver = new MASP_BalMatch();
-		solver->Solve(&input, &solution);
+	if(args.size() >= 5) {
+		runnum = atoi(args.at(4).c_str());
 	}
-	break;
 
-	case e_Algo_MASP_MTCHACT: {
-		solver = new MASP_MatchAct();
-		solver->Solve(&input, &solution);
-	}
-	break;
-
-	case e_Algo_MASP_EDGCUT: {
-		solver = new MASP_EdgeCutting();
-		solver->Solve(&input, &solution);
-	}
-	break;
-
-	case e_Algo_MASP_GRADSEARCH: {
-		solver = new MASP_GradientSearch();
-		solver->Solve(&input, &solution);
-	}
-	break;
-
-	case e_Algo_MASP_MTCHGS: {
-		solver = new MASP_MatchGS();
-		solver->Solve(&input, &solution);
-	}
-	break;
-
-	case e_Algo_MASP_MIN_DIST: {
-		solver = new MASP_MinDist();
-		solver->Solve(&input, &solution);
-	}
-	break;
-
-	case e_Algo_MASP_LOGMATCH: {
-		solver = new MASP_LogBalMatch();
-		solver->Solve(&input, &solution);
-	}
-	break;
-
-	case e_Algo_MASP_SWAP: {
-		solver = new MASP_Swap();
-		solver->Solve(&input, &solution);
+	// Create the requested solver
+	Solver* solver = SolverRegistry::Instance().Create(algorithm, &algorithmID);
+	if(solver == NULL) {
+		// No valid algorithm given
+		fprintf(stderr, "[ERROR][main] : \n\tInvalid algorithm identifier \"%s\"!\n", algorithm.c_str());
+		SolverRegistry::Instance().PrintSolvers(stderr);
+		exit(1);
 	}
-	break;
+	solver->SetOptions(options);
+	srand(options.nSeed);
 
-	case e_Algo_MASP_BNM: {
-		solver = new MASP_BranchAndMatch();
-		solver->Solve(&input, &solution);
-	}
-	break;
+	if(SANITY_PRINT)
+		options.Print(stdout);
 
-	case e_Algo_MASP_BNB: {
-		solver = new MASP_BranchAndBound();
-		solver->Solve(&input, &solution);
-	}
-	break;
+	MASPInput input(args.at(0).c_str());
+	I_solution solution(&input);
 
-	default:
-		// No valid algorithm given
-		fprintf(stderr, "[ERROR][main] : \n\tInvalid algorithm identifier!\n");
-		exit(1);
+	// Capture start time
+	auto start = std::chrono::high_resolution_clock::now();
 
+	// Run the solver, within the time limit if one was given
+	Solver::Clock::time_point deadline = Solver::Clock::time_point::max();
+	if(options.fTimeLimit > 0) {
+		deadline = Solver::Clock::now() + std::chrono::duration_cast<Solver::Clock::duration>(std::chrono::duration<double>(options.fTimeLimit));
 	}
+	SolveResult result = solver->SolveWithin(&input, &solution, deadline, NULL);
 
 	// Capture end time
 	auto stop = std::chrono::high_resolution_clock::now();
@@ -176,6 +93,12 @@ int main(int argc, char *argv[]) {
 		printf("\nUpper bound on solution: %f\n", upperBound);
 		printf("Closed-form Z = %f\n", closed_Z);
 		printf("Average Z_i = %f\n", average_Z_i);
+		printf("Proven optimal = %d, stopped early = %d\n", result.bOptimal, result.bStopped);
+		printf("Stats: ");
+		SolverStats::PrintHeader(stdout);
+		printf("\n       ");
+		solver->GetStats().Print(stdout);
+		printf("\n");
 	}
 
 	// Determine how well this solution worksoutputPath
@@ -199,7 +122,7 @@ int main(int argc, char *argv[]) {
 		FILE * pOutputFile;
 		char buff[100];
 		sprintf(buff, "%s", outputPath);
-		sprintf(buff + strlen(buff), DATA_LOG_FORMAT, algorithm);
+		sprintf(buff + strlen(buff), DATA_LOG_FORMAT, algorithmID);
 		if(SANITY_PRINT)
 			printf(" Printing results to: %s\n", buff);
 		pOutputFile = fopen(buff, "a");
@@ -207,14 +130,14 @@ int main(int argc, char *argv[]) {
 		fprintf(pOutputFile, "%d %d %d ", input.getN(), input.getM(), runnum);
 		fprintf(pOutputFile, "%.10f %.10f %.10f %f", closed_Z, estimated_Z, upperBound, duration_s);
 		// If this does gradient search, print the number of times the algorithm iterated
-		if(algorithm == e_Algo_MASP_GRADSEARCH) {
-			fprintf(pOutputFile, " %d", ((MASP_GradientSearch*)solver)->getIterations());
-		}
-		else if(algorithm == e_Algo_MASP_MTCHGS) {
-			fprintf(pOutputFile, " %d", ((MASP_MatchGS*)solver)->getIterations());
+		if(solver->getIterations() >= 0) {
+			fprintf(pOutputFile, " %d", solver->getIterations());
 		}
 		fprintf(pOutputFile, " %d", solution.ValidSolution());
-		fprintf(pOutputFile, " %f\n", average_Z_i);
+		fprintf(pOutputFile, " %f", average_Z_i);
+		fprintf(pOutputFile, " %d ", result.bOptimal);
+		solver->GetStats().Print(pOutputFile);
+		fprintf(pOutputFile, "\n");
 		fclose(pOutputFile);
 	}
 
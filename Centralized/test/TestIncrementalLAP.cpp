@@ -0,0 +1,163 @@
+/*
+ * TestIncrementalLAP.cpp
+ *
+ * Created by:	Jonathan Diller
+ * On: 			Oct 18, 2026
+ *
+ * Description: Randomized check of IncrementalLAP. Random square problems, some with
+ * INF entries like the balanced-matching matrices, go through a sequence of Solve(),
+ * UpdateRow(), UpdateColumn(), Add() and RemoveRowColumn() calls. After each one the
+ * cost of the repaired matching must match the Munkres solution of the same matrix from
+ * scratch, and the matching must be a permutation with that cost.
+ *
+ * Usage: test-incremental-lap [seed] [rounds]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+#include <random>
+
+#include "defines.h"
+#include "Hungarian.h"
+#include "IncrementalLAP.h"
+
+#define TEST_TOL	1e-6
+
+
+// Random cost, INF with probability fInf
+double randomCost(std::mt19937& rng, double fInf) {
+	std::uniform_real_distribution<double> uniform(0.0, 1.0);
+	if(uniform(rng) < fInf) {
+		return INF;
+	}
+	return uniform(rng);
+}
+
+// Compares lap against a full Munkres solve of matrix, prints what went wrong and returns false on a mismatch
+bool check(IncrementalLAP& lap, const std::vector<std::vector<double>>& matrix, const char* step) {
+	int n = matrix.size();
+	if(lap.Size() != n) {
+		printf("%s: size %d, expected %d\n", step, lap.Size(), n);
+		return false;
+	}
+
+	std::vector<std::vector<double>> copy = matrix;
+	std::vector<int> assignment;
+	HungarianAlgorithm munkres;
+	munkres.SetMethod(e_Assign_Munkres);
+	double expected = (n > 0) ? munkres.Solve(copy, assignment) : 0;
+
+	// The incremental matching has to be a permutation whose cost is the optimum
+	std::vector<bool> used(n, false);
+	double cost = 0;
+	for(int i = 0; i < n; i++) {
+		int j = lap.Assignment(i);
+		if(j < 0 || j >= n || used.at(j)) {
+			printf("%s: row %d has column %d\n", step, i, j);
+			return false;
+		}
+		used.at(j) = true;
+		cost += matrix.at(i).at(j);
+	}
+
+	if(fabs(cost - expected) > TEST_TOL*std::max(1.0, fabs(expected)) || fabs(lap.Cost() - cost) > TEST_TOL*std::max(1.0, fabs(cost))) {
+		printf("%s: n = %d, incremental cost = %f (reported %f), Munkres = %f\n", step, n, cost, lap.Cost(), expected);
+		return false;
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv) {
+	unsigned int seed = (argc > 1) ? strtoul(argv[1], NULL, 10) : 1;
+	int rounds = (argc > 2) ? atoi(argv[2]) : 200;
+	std::mt19937 rng(seed);
+
+	int checks = 0;
+	for(int round = 0; round < rounds; round++) {
+		int n = 1 + rng()%12;
+		// Half of the problems have INF entries, the diagonal stays finite so a finite matching exists
+		double fInf = (round%2 == 0) ? 0.0 : 0.3;
+		std::vector<std::vector<double>> matrix(n, std::vector<double>(n));
+		for(int i = 0; i < n; i++) {
+			for(int j = 0; j < n; j++) {
+				matrix.at(i).at(j) = (i == j) ? randomCost(rng, 0) : randomCost(rng, fInf);
+			}
+		}
+
+		IncrementalLAP lap;
+		lap.Solve(matrix);
+		if(!check(lap, matrix, "Solve")) {
+			return 1;
+		}
+		checks++;
+
+		for(int step = 0; step < 20; step++) {
+			int op = rng()%4;
+			if(matrix.size() <= 1 && op == 3) {
+				op = 2;
+			}
+			n = matrix.size();
+			const char* name = "";
+
+			if(op == 0) {
+				// New costs for a row, INF kept off the diagonal
+				int i = rng()%n;
+				std::vector<double> row(n);
+				for(int j = 0; j < n; j++) {
+					row.at(j) = (i == j) ? randomCost(rng, 0) : randomCost(rng, fInf);
+				}
+				matrix.at(i) = row;
+				lap.UpdateRow(i, row);
+				name = "UpdateRow";
+			}
+			else if(op == 1) {
+				// New costs for a column
+				int j = rng()%n;
+				std::vector<double> col(n);
+				for(int i = 0; i < n; i++) {
+					col.at(i) = (i == j) ? randomCost(rng, 0) : randomCost(rng, fInf);
+					matrix.at(i).at(j) = col.at(i);
+				}
+				lap.UpdateColumn(j, col);
+				name = "UpdateColumn";
+			}
+			else if(op == 2) {
+				// One more row and column, the new diagonal entry is finite
+				std::vector<double> row(n + 1);
+				std::vector<double> col(n);
+				for(int j = 0; j <= n; j++) {
+					row.at(j) = (j == n) ? randomCost(rng, 0) : randomCost(rng, fInf);
+				}
+				for(int i = 0; i < n; i++) {
+					col.at(i) = randomCost(rng, fInf);
+					matrix.at(i).push_back(col.at(i));
+				}
+				matrix.push_back(row);
+				lap.Add(row, col);
+				name = "Add";
+			}
+			else {
+				// Drop a diagonal pair, which keeps the diagonal finite
+				int k = rng()%n;
+				matrix.erase(matrix.begin() + k);
+				for(std::vector<double>& row : matrix) {
+					row.erase(row.begin() + k);
+				}
+				lap.RemoveRowColumn(k, k);
+				name = "RemoveRowColumn";
+			}
+
+			if(!check(lap, matrix, name)) {
+				printf("Failed in round %d, step %d (seed %u)\n", round, step, seed);
+				return 1;
+			}
+			checks++;
+		}
+	}
+
+	printf("IncrementalLAP matched Munkres in %d checks (seed %u)\n", checks, seed);
+	return 0;
+}
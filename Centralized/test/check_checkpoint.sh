@@ -0,0 +1,54 @@
+#!/bin/bash
+
+# Checks that bnm refuses damaged checkpoints instead of resuming from them. A full
+# run leaves a checkpoint, which must resume to the same result. The same file cut
+# short, with a flipped byte, or with an options vector claiming 2^31-1 entries under
+# a valid checksum must each stop the resume with the checkpoint error.
+#
+# Usage: check_checkpoint.sh <find-assignment> <instance>
+
+binary=$1
+instance=$2
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+# Resumes from checkpoint $1, prints the exit code and the error
+resume() {
+	"$binary" "$instance" bnm 1 "$out/resume_" 0 --seed=1 --checkpoint="$1" --resume 2>&1 > /dev/null
+	echo "exit $?"
+}
+
+status=0
+"$binary" "$instance" bnm 1 "$out/full_" 0 --seed=1 --checkpoint="$out/good.ckpt" > /dev/null || exit 1
+size=$(stat -c %s "$out/good.ckpt")
+
+if [ "$(resume $out/good.ckpt)" != "exit 0" ]; then
+	echo "intact checkpoint: resume failed"
+	status=1
+fi
+
+head -c $((size - 5)) "$out/good.ckpt" > "$out/short.ckpt"
+cp "$out/good.ckpt" "$out/flipped.ckpt"
+printf '\x55' | dd of="$out/flipped.ckpt" bs=1 seek=$((size / 2)) conv=notrunc status=none
+# vOptions length (after the magic, version, input hash, N and M) set to 2^31-1, checksum fixed up
+python3 - "$out/good.ckpt" "$out/huge.ckpt" <<'PY'
+import struct, sys
+data = bytearray(open(sys.argv[1], 'rb').read()[:-8])
+data[28:32] = struct.pack('<i', 2**31 - 1)
+h = 14695981039346656037
+for b in data:
+	h = ((h ^ b) * 1099511628211) & 0xFFFFFFFFFFFFFFFF
+open(sys.argv[2], 'wb').write(bytes(data) + struct.pack('<Q', h))
+PY
+
+for bad in short flipped huge
+do
+	result=$(resume "$out/$bad.ckpt")
+	echo "$bad: $(echo "$result" | tr '\n' ' ')"
+	if ! echo "$result" | grep -q "exit 1" || ! echo "$result" | grep -q "not a complete checkpoint"; then
+		echo "  expected the checkpoint to be refused"
+		status=1
+	fi
+done
+
+exit $status
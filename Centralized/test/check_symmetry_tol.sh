@@ -0,0 +1,40 @@
+#!/bin/bash
+
+# Checks that an exact solver run with --symmetry-tol above 0 is not reported as
+# optimal. On plot_14_0 the tolerance merges agents that are not interchangeable
+# and bnm, fast-comp and bnb return a lower Z than the exact run, so the last
+# column of the results file must be 0 there and 1 for the exact run.
+#
+# Usage: check_symmetry_tol.sh <find-assignment> <instance>
+
+set -e
+binary=$1
+instance=$2
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+# Z and the optimal flag of the last line of a results file (alg_<number>.dat)
+result() {
+	tail -n 1 "$1" | cut -d' ' -f4,10
+}
+
+status=0
+for alg in bnm fast-comp bnb
+do
+	"$binary" "$instance" $alg 1 "$out/${alg}_exact_" 0 --seed=1 > /dev/null
+	"$binary" "$instance" $alg 1 "$out/${alg}_tol_" 0 --seed=1 --symmetry=1 --symmetry-tol=0.5 > /dev/null
+	read exactZ exactOpt <<< "$(result $out/${alg}_exact_alg_*.dat)"
+	read tolZ tolOpt <<< "$(result $out/${alg}_tol_alg_*.dat)"
+	echo "$alg: exact Z = $exactZ (optimal $exactOpt), tol 0.5 Z = $tolZ (optimal $tolOpt)"
+
+	if [ "$exactOpt" != "1" ] || [ "$tolOpt" != "0" ]; then
+		echo "  wrong optimal flag"
+		status=1
+	fi
+	if ! awk -v a="$tolZ" -v b="$exactZ" 'BEGIN {exit !(a < b)}'; then
+		echo "  expected the tolerance to cost some Z on this instance"
+		status=1
+	fi
+done
+
+exit $status
@@ -0,0 +1,33 @@
+#!/bin/bash
+
+# Checks that the heuristics that run long on big instances return close to
+# --time-limit. Without a limit swap and edge-cut run for over a minute on
+# Experiments7/plot_100_0. With the limit, the solve time in the results file must be
+# within 0.1 s of it, and the whole run within 1 s of it (that also covers reading the
+# input and the Monte Carlo estimate of Z).
+#
+# Usage: check_time_limit.sh <find-assignment> <instance> [limit]
+
+binary=$1
+instance=$2
+limit=${3:-1}
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+status=0
+for alg in swap edge-cut
+do
+	start=$(date +%s.%N)
+	"$binary" "$instance" $alg 1 "$out/${alg}_" 0 --seed=1 --time-limit=$limit > /dev/null
+	stop=$(date +%s.%N)
+	wall=$(awk -v a="$start" -v b="$stop" 'BEGIN {print b - a}')
+	solve=$(tail -n 1 $out/${alg}_alg_*.dat | cut -d' ' -f7)
+	echo "$alg: time limit $limit s, solve time $solve s, run time $wall s"
+
+	if ! awk -v s="$solve" -v w="$wall" -v l="$limit" 'BEGIN {exit !(s <= l + 0.1 && w <= l + 1)}'; then
+		echo "  ran past the time limit"
+		status=1
+	fi
+done
+
+exit $status
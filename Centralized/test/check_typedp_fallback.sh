@@ -0,0 +1,24 @@
+#!/bin/bash
+
+# Checks that type-dp falls back on the heuristic when the instance has too many agent
+# types for its tables (plot_24_3 has 24). The run must succeed and write a results
+# row with Z above 0 and the optimal column at 0.
+#
+# Usage: check_typedp_fallback.sh <find-assignment> <instance>
+
+binary=$1
+instance=$2
+out=$(mktemp -d)
+trap 'rm -rf "$out"' EXIT
+
+if ! "$binary" "$instance" type-dp 1 "$out/" 0 --seed=1 > /dev/null; then
+	echo "type-dp failed"
+	exit 1
+fi
+
+read Z optimal <<< "$(tail -n 1 $out/alg_*.dat | cut -d' ' -f4,10)"
+echo "type-dp: Z = $Z, optimal $optimal"
+if [ "$optimal" != "0" ] || ! awk -v z="$Z" 'BEGIN {exit !(z > 0)}'; then
+	echo "  expected the heuristic's assignment, not marked optimal"
+	exit 1
+fi
@@ -0,0 +1,39 @@
+#!/bin/bash
+
+# Compares the Munkres and LAPJV assignment solvers on the balanced-matching
+# matrices built by Bal-Matching (3), Min-Dist (8), Log-Matching (9) and, for the
+# smaller instances, Match and Swap (10). Each run appends a line to
+# AssignmentBench/<method>/alg_<algorithm>.dat; the assignment_time column of the
+# two files holds the time spent inside the assignment solver. The runs force
+# --matching=matrix, the default flow matching never calls either solver.
+
+set -e
+echo "Running assignment solver benchmark"
+
+for method in munkres lapjv
+do
+	mkdir -p AssignmentBench/$method/
+
+	for n in 50 100 150 200
+	do
+		for i in 0 1 2 3 4
+		do
+			for alg in 3 8 9
+			do
+				echo "Running algorithm $alg with $method on plot_${n}_$i"
+				../build/find-assignment "Experiments7/plot_${n}_$i.txt" $alg 1 AssignmentBench/$method/ $n --seed=$i --matching=matrix --assignment=$method >> AssignmentBench/output.txt 2>&1&
+				wait
+			done
+		done
+	done
+
+	for n in 10 15 20 25 30
+	do
+		for i in 0 1 2 3 4
+		do
+			echo "Running Match and Swap with $method on plot_${n}_$i"
+			../build/find-assignment "Experiments5/plot_${n}_$i.txt" 10 1 AssignmentBench/$method/ $n --seed=$i --matching=matrix --assignment=$method >> AssignmentBench/output.txt 2>&1&
+			wait
+		done
+	done
+done